@@ -0,0 +1,33 @@
+/**
+ * @file bench.c
+ *
+ * Effect benchmark on host, all sizes from 8x8 to 256x256. Effects with
+ * `rows` are also run tiled, on a worker per CPU, fails if their frames
+ * differ from frames rendered on a single thread.
+ *
+ * Usage: bench [frames] > bench.log
+ */
+#include <stdlib.h>
+#include <unistd.h>
+
+#include <effects/bench.h>
+
+#define DEFAULT_FRAMES 100
+
+int main(int argc, char **argv)
+{
+    static const size_t sizes[] = { 8, 16, 32, 64, 128, 256 };
+    size_t frames = argc > 1 ? strtoul(argv[1], NULL, 0) : DEFAULT_FRAMES;
+    if (!frames)
+        return EXIT_FAILURE;
+
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    static led_effect_tiles_t tiles;
+    ESP_ERROR_CHECK(led_effect_tiles_init(&tiles, MIN(MAX(cpus, 1), LED_EFFECT_MAX_WORKERS)));
+
+    esp_err_t res = led_effect_benchmark(sizes, sizeof(sizes) / sizeof(sizes[0]), frames, &tiles);
+
+    led_effect_tiles_free(&tiles);
+
+    return res == ESP_OK ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,22 @@
+/**
+ * @file golden.c
+ *
+ * Golden checksums of effects on host, same lines as printed by the
+ * device with CONFIG_EXAMPLE_EFFECT_GOLDEN, check them with
+ * tools/golden.py against tools/golden.csv.
+ *
+ * Usage: golden [frames] > golden.log
+ */
+#include <stdlib.h>
+
+#include <effects/bench.h>
+
+#define GOLDEN_SIZE    16
+#define DEFAULT_FRAMES 100
+
+int main(int argc, char **argv)
+{
+    size_t frames = argc > 1 ? strtoul(argv[1], NULL, 0) : DEFAULT_FRAMES;
+
+    return led_effect_golden(GOLDEN_SIZE, frames) == ESP_OK ? EXIT_SUCCESS : EXIT_FAILURE;
+}
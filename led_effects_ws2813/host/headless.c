@@ -0,0 +1,122 @@
+/**
+ * @file headless.c
+ *
+ * Play every effect on host through output stage and mock backend,
+ * record flushed frames into frame log. Time is virtual, every frame is
+ * a single step at reference rate, so logs are reproducible and can be
+ * compared with tools/framelog.py. Prints the number of records, fails if
+ * any effect could not be played or a frame was neither flushed nor
+ * skipped as unchanged.
+ *
+ * Usage: headless <frame log> [frames] [width] [height]
+ */
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <output/output.h>
+#include <output/backends.h>
+#include <effects/effect.h>
+
+#define DEFAULT_FRAMES 100
+#define DEFAULT_SIZE   16
+
+static int64_t virtual_time = 0;
+
+static int64_t virtual_clock(void)
+{
+    return virtual_time;
+}
+
+// parameters in the middle of their ranges
+static void middle_params(const led_effect_t *effect, uint8_t *params)
+{
+    for (size_t p = 0; p < effect->num_params; p++)
+        params[p] = (effect->params[p].min + effect->params[p].max) / 2;
+}
+
+int main(int argc, char **argv)
+{
+    if (argc < 2)
+    {
+        fprintf(stderr, "Usage: %s <frame log> [frames] [width] [height]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+    size_t frames = argc > 2 ? strtoul(argv[2], NULL, 0) : DEFAULT_FRAMES;
+    size_t width = argc > 3 ? strtoul(argv[3], NULL, 0) : DEFAULT_SIZE;
+    size_t height = argc > 4 ? strtoul(argv[4], NULL, 0) : width;
+
+    // whole matrix is a single panel on a single lane
+    static const layout_panel_t panel = { .wiring = LAYOUT_WIRING_PROGRESSIVE };
+    const layout_t layout = {
+        .panel_width = width,
+        .panel_height = height,
+        .cols = 1,
+        .rows = 1,
+        .panels = &panel,
+    };
+    const output_config_t config = {
+        .backend = &output_backend_mock,
+        .layout = &layout,
+        .brightness = 255,
+        .gamma = 1.0f,
+        .white = { .r = 255, .g = 255, .b = 255 },
+        .channel_current = 50,
+        .num_lanes = 1,
+    };
+    static output_t out;
+    ESP_ERROR_CHECK(output_init(&out, &config));
+
+    FILE *file = fopen(argv[1], "wb");
+    if (!file)
+    {
+        perror(argv[1]);
+        return EXIT_FAILURE;
+    }
+    static frame_log_t log;
+    ESP_ERROR_CHECK(frame_log_init(&log, file, FRAME_LOG_DATA, virtual_clock));
+    output_backend_mock_set_log(&log);
+
+    framebuffer_t fb;
+    ESP_ERROR_CHECK(fb_init(&fb, width, height, output_render));
+    led_effect_set_time_source(virtual_clock);
+
+    size_t skipped = 0;
+    for (size_t i = 0; i < led_effects_count; i++)
+    {
+        const led_effect_t *effect = led_effects[i];
+        uint8_t params[LED_EFFECT_MAX_PARAMS];
+        middle_params(effect, params);
+
+        led_effect_set_seed(i + 1);
+        fb_clear(&fb);
+        if (effect->init(&fb, params) != ESP_OK)
+        {
+            fprintf(stderr, "Could not init effect %s at %zux%zu\n", effect->name, width, height);
+            skipped++;
+            continue;
+        }
+        for (size_t f = 0; f < frames; f++)
+        {
+            ESP_ERROR_CHECK(effect->run(&fb));
+            ESP_ERROR_CHECK(fb_render(&fb, &out));
+            virtual_time += 1000000 / LED_EFFECT_REF_FPS;
+        }
+        effect->done(&fb);
+    }
+
+    fprintf(stderr, "%u records written to %s, %u unchanged frames skipped\n", log.records, argv[1], out.skipped);
+    printf("%u\n", log.records);
+    size_t played = (led_effects_count - skipped) * frames;
+    if (out.flushed + out.skipped != played || log.records != out.flushed * out.num_lanes)
+    {
+        fprintf(stderr, "%zu frames played, %u flushed, %u skipped\n", played, out.flushed, out.skipped);
+        skipped++;
+    }
+
+    output_backend_mock_set_log(NULL);
+    fclose(file);
+    fb_free(&fb);
+    output_free(&out);
+
+    return skipped ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,177 @@
+/**
+ * @file color.c
+ *
+ * Minimal stand-in for the esp-idf-lib color component
+ */
+#include <lib8tion.h>
+#include <color.h>
+
+rgb_t rgb_scale(rgb_t color, uint8_t scale)
+{
+    return rgb_from_values(scale8(color.r, scale), scale8(color.g, scale), scale8(color.b, scale));
+}
+
+rgb_t rgb_scale_video(rgb_t color, uint8_t scale)
+{
+    return rgb_from_values(scale8_video(color.r, scale), scale8_video(color.g, scale),
+            scale8_video(color.b, scale));
+}
+
+rgb_t rgb_add_rgb(rgb_t a, rgb_t b)
+{
+    return rgb_from_values(qadd8(a.r, b.r), qadd8(a.g, b.g), qadd8(a.b, b.b));
+}
+
+uint8_t rgb_luma(rgb_t color)
+{
+    return scale8(color.r, 54) + scale8(color.g, 183) + scale8(color.b, 18);
+}
+
+rgb_t hsv2rgb_rainbow(hsv_t hsv)
+{
+    uint8_t offset8 = (hsv.h & 0x1f) << 3;
+    uint8_t third = scale8(offset8, 256 / 3);
+    uint8_t twothirds = scale8(offset8, 256 * 2 / 3);
+    uint8_t r, g, b;
+
+    switch (hsv.h >> 5)
+    {
+        case 0: // red -> orange
+            r = 255 - third; g = third; b = 0;
+            break;
+        case 1: // orange -> yellow
+            r = 171; g = 85 + third; b = 0;
+            break;
+        case 2: // yellow -> green
+            r = 171 - twothirds; g = 170 + third; b = 0;
+            break;
+        case 3: // green -> aqua
+            r = 0; g = 255 - third; b = third;
+            break;
+        case 4: // aqua -> blue
+            r = 0; g = 171 - twothirds; b = 85 + twothirds;
+            break;
+        case 5: // blue -> purple
+            r = third; g = 0; b = 255 - third;
+            break;
+        case 6: // purple -> pink
+            r = 85 + third; g = 0; b = 171 - third;
+            break;
+        default: // pink -> red
+            r = 170 + third; g = 0; b = 85 - third;
+            break;
+    }
+
+    if (hsv.s != 255)
+    {
+        if (!hsv.s)
+            r = g = b = 255;
+        else
+        {
+            uint8_t desat = scale8_video(255 - hsv.s, 255 - hsv.s);
+            uint8_t satscale = 255 - desat;
+            r = scale8(r, satscale) + desat;
+            g = scale8(g, satscale) + desat;
+            b = scale8(b, satscale) + desat;
+        }
+    }
+
+    if (hsv.v != 255)
+    {
+        uint8_t val = scale8_video(hsv.v, hsv.v);
+        r = val ? scale8(r, val) : 0;
+        g = val ? scale8(g, val) : 0;
+        b = val ? scale8(b, val) : 0;
+    }
+
+    return rgb_from_values(r, g, b);
+}
+
+// channels in Q8.8, steps twice the Q8.7 distance per pixel as FastLED does
+static void fill_gradient_rgb(rgb_t *target, size_t start, rgb_t c1, size_t end, rgb_t c2)
+{
+    int32_t divisor = end > start ? end - start : 1;
+    int16_t dr = (((c2.r - c1.r) * 128) / divisor) * 2;
+    int16_t dg = (((c2.g - c1.g) * 128) / divisor) * 2;
+    int16_t db = (((c2.b - c1.b) * 128) / divisor) * 2;
+    uint16_t r = c1.r << 8, g = c1.g << 8, b = c1.b << 8;
+
+    for (size_t i = start; i <= end; i++, r += dr, g += dg, b += db)
+        target[i] = rgb_from_values(r >> 8, g >> 8, b >> 8);
+}
+
+void rgb_fill_gradient4_rgb(rgb_t *target, size_t num, rgb_t c1, rgb_t c2, rgb_t c3, rgb_t c4)
+{
+    size_t onethird = num / 3;
+    size_t twothirds = num * 2 / 3;
+
+    fill_gradient_rgb(target, 0, c1, onethird, c2);
+    fill_gradient_rgb(target, onethird, c2, twothirds, c3);
+    fill_gradient_rgb(target, twothirds, c3, num - 1, c4);
+}
+
+static void fill_gradient_hsv(rgb_t *target, size_t start, hsv_t c1, size_t end, hsv_t c2,
+        color_gradient_direction_t dir)
+{
+    // fading to or from black or white keeps the hue
+    if (!c2.v || !c2.s)
+        c2.h = c1.h;
+    if (!c1.v || !c1.s)
+        c1.h = c2.h;
+
+    uint8_t hue_delta = c2.h - c1.h;
+    if (dir == COLOR_SHORTEST_HUES)
+        dir = hue_delta > 127 ? COLOR_BACKWARD_HUES : COLOR_FORWARD_HUES;
+    else if (dir == COLOR_LONGEST_HUES)
+        dir = hue_delta < 128 ? COLOR_BACKWARD_HUES : COLOR_FORWARD_HUES;
+    int32_t hue_distance = dir == COLOR_FORWARD_HUES
+        ? hue_delta << 7
+        : -((uint8_t)(256 - hue_delta) << 7);
+
+    int32_t divisor = end > start ? end - start : 1;
+    int16_t dh = (hue_distance / divisor) * 2;
+    int16_t ds = (((c2.s - c1.s) * 128) / divisor) * 2;
+    int16_t dv = (((c2.v - c1.v) * 128) / divisor) * 2;
+    uint16_t h = c1.h << 8, s = c1.s << 8, v = c1.v << 8;
+
+    for (size_t i = start; i <= end; i++, h += dh, s += ds, v += dv)
+        target[i] = hsv2rgb_rainbow(hsv_from_values(h >> 8, s >> 8, v >> 8));
+}
+
+void rgb_fill_gradient4_hsv(rgb_t *target, size_t num, hsv_t c1, hsv_t c2, hsv_t c3, hsv_t c4,
+        color_gradient_direction_t dir)
+{
+    size_t onethird = num / 3;
+    size_t twothirds = num * 2 / 3;
+
+    fill_gradient_hsv(target, 0, c1, onethird, c2, dir);
+    fill_gradient_hsv(target, onethird, c2, twothirds, c3, dir);
+    fill_gradient_hsv(target, twothirds, c3, num - 1, c4, dir);
+}
+
+rgb_t color_from_palette_rgb(const rgb_t *palette, uint32_t pal_size, uint8_t pal_idx,
+        uint8_t brightness, bool blend)
+{
+    if (!pal_size)
+        return rgb_from_values(0, 0, 0);
+
+    // entry and position between it and the next one, in 1/256
+    uint32_t pos = (uint32_t)pal_idx * pal_size;
+    const rgb_t *entry = palette + (pos >> 8);
+    uint8_t f2 = pos & 0xff;
+    rgb_t res = *entry;
+
+    if (blend && f2)
+    {
+        const rgb_t *next = (size_t)(entry - palette) == pal_size - 1 ? palette : entry + 1;
+        uint8_t f1 = 255 - f2;
+        res = rgb_from_values(scale8(res.r, f1) + scale8(next->r, f2),
+                scale8(res.g, f1) + scale8(next->g, f2),
+                scale8(res.b, f1) + scale8(next->b, f2));
+    }
+
+    if (brightness != 255)
+        res = brightness ? rgb_scale(res, brightness + 1) : rgb_from_values(0, 0, 0);
+
+    return res;
+}
@@ -0,0 +1,76 @@
+/**
+ * @file color.h
+ *
+ * Minimal stand-in for the esp-idf-lib color component: the types and
+ * the functions effects use, ported from FastLED, used when esp-idf-lib
+ * is not available
+ */
+#ifndef __HOST_COLOR_H__
+#define __HOST_COLOR_H__
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+typedef struct
+{
+    union { uint8_t r; uint8_t red; };
+    union { uint8_t g; uint8_t green; };
+    union { uint8_t b; uint8_t blue; };
+} rgb_t;
+
+typedef struct
+{
+    union { uint8_t h; uint8_t hue; };
+    union { uint8_t s; uint8_t sat; uint8_t saturation; };
+    union { uint8_t v; uint8_t val; uint8_t value; };
+} hsv_t;
+
+typedef enum {
+    COLOR_FORWARD_HUES = 0,
+    COLOR_BACKWARD_HUES,
+    COLOR_SHORTEST_HUES,
+    COLOR_LONGEST_HUES,
+} color_gradient_direction_t;
+
+static inline rgb_t rgb_from_values(uint8_t r, uint8_t g, uint8_t b)
+{
+    rgb_t res = { .r = r, .g = g, .b = b };
+    return res;
+}
+
+static inline rgb_t rgb_from_code(uint32_t color_code)
+{
+    return rgb_from_values(color_code >> 16, color_code >> 8, color_code);
+}
+
+static inline uint32_t rgb_to_code(rgb_t color)
+{
+    return ((uint32_t)color.r << 16) | ((uint32_t)color.g << 8) | color.b;
+}
+
+static inline hsv_t hsv_from_values(uint8_t h, uint8_t s, uint8_t v)
+{
+    hsv_t res = { .h = h, .s = s, .v = v };
+    return res;
+}
+
+rgb_t rgb_scale(rgb_t color, uint8_t scale);
+
+rgb_t rgb_scale_video(rgb_t color, uint8_t scale);
+
+rgb_t rgb_add_rgb(rgb_t a, rgb_t b);
+
+uint8_t rgb_luma(rgb_t color);
+
+rgb_t hsv2rgb_rainbow(hsv_t hsv);
+
+void rgb_fill_gradient4_rgb(rgb_t *target, size_t num, rgb_t c1, rgb_t c2, rgb_t c3, rgb_t c4);
+
+void rgb_fill_gradient4_hsv(rgb_t *target, size_t num, hsv_t c1, hsv_t c2, hsv_t c3, hsv_t c4,
+        color_gradient_direction_t dir);
+
+rgb_t color_from_palette_rgb(const rgb_t *palette, uint32_t pal_size, uint8_t pal_idx,
+        uint8_t brightness, bool blend);
+
+#endif /* __HOST_COLOR_H__ */
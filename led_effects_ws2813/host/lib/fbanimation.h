@@ -0,0 +1,14 @@
+/**
+ * @file fbanimation.h
+ *
+ * Minimal stand-in for the esp-idf-lib framebuffer animation API:
+ * draw callback type only, used when esp-idf-lib is not available
+ */
+#ifndef __HOST_FBANIMATION_H__
+#define __HOST_FBANIMATION_H__
+
+#include <framebuffer.h>
+
+typedef esp_err_t (*fb_draw_cb_t)(framebuffer_t *fb);
+
+#endif /* __HOST_FBANIMATION_H__ */
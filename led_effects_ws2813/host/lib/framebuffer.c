@@ -0,0 +1,180 @@
+/**
+ * @file framebuffer.c
+ *
+ * Minimal stand-in for the esp-idf-lib framebuffer component
+ */
+#include <stdlib.h>
+#include <string.h>
+#include <esp_timer.h>
+#include <lib8tion.h>
+#include <framebuffer.h>
+
+#define CHECK_ARG(VAL) do { if (!(VAL)) return ESP_ERR_INVALID_ARG; } while (0)
+
+esp_err_t fb_init(framebuffer_t *fb, size_t width, size_t height, fb_render_cb_t render_cb)
+{
+    CHECK_ARG(fb && width && height);
+
+    memset(fb, 0, sizeof(framebuffer_t));
+    fb->width = width;
+    fb->height = height;
+    fb->render = render_cb;
+    fb->data = calloc(width * height, sizeof(rgb_t));
+    fb->mutex = xSemaphoreCreateMutex();
+    if (!fb->data || !fb->mutex)
+    {
+        fb_free(fb);
+        return ESP_ERR_NO_MEM;
+    }
+
+    return ESP_OK;
+}
+
+esp_err_t fb_free(framebuffer_t *fb)
+{
+    CHECK_ARG(fb);
+
+    free(fb->data);
+    fb->data = NULL;
+    vSemaphoreDelete(fb->mutex);
+    fb->mutex = NULL;
+
+    return ESP_OK;
+}
+
+esp_err_t fb_begin(framebuffer_t *fb)
+{
+    CHECK_ARG(fb);
+
+    return xSemaphoreTake(fb->mutex, portMAX_DELAY) ? ESP_OK : ESP_ERR_TIMEOUT;
+}
+
+esp_err_t fb_end(framebuffer_t *fb)
+{
+    CHECK_ARG(fb);
+
+    fb->frame_num++;
+    fb->last_frame_us = esp_timer_get_time();
+    xSemaphoreGive(fb->mutex);
+
+    return ESP_OK;
+}
+
+esp_err_t fb_render(framebuffer_t *fb, void *render_ctx)
+{
+    CHECK_ARG(fb && fb->render);
+
+    if (!xSemaphoreTake(fb->mutex, portMAX_DELAY))
+        return ESP_ERR_TIMEOUT;
+    esp_err_t res = fb->render(fb, render_ctx);
+    xSemaphoreGive(fb->mutex);
+
+    return res;
+}
+
+esp_err_t fb_clear(framebuffer_t *fb)
+{
+    CHECK_ARG(fb);
+
+    memset(fb->data, 0, fb->width * fb->height * sizeof(rgb_t));
+
+    return ESP_OK;
+}
+
+esp_err_t fb_set_pixel_rgb(framebuffer_t *fb, size_t x, size_t y, rgb_t color)
+{
+    CHECK_ARG(fb && x < fb->width && y < fb->height);
+
+    fb->data[FB_OFFSET(fb, x, y)] = color;
+
+    return ESP_OK;
+}
+
+esp_err_t fb_get_pixel_rgb(framebuffer_t *fb, size_t x, size_t y, rgb_t *color)
+{
+    CHECK_ARG(fb && color && x < fb->width && y < fb->height);
+
+    *color = fb->data[FB_OFFSET(fb, x, y)];
+
+    return ESP_OK;
+}
+
+esp_err_t fb_set_pixel_hsv(framebuffer_t *fb, size_t x, size_t y, hsv_t color)
+{
+    return fb_set_pixel_rgb(fb, x, y, hsv2rgb_rainbow(color));
+}
+
+esp_err_t fb_fade(framebuffer_t *fb, uint8_t scale)
+{
+    CHECK_ARG(fb);
+
+    for (size_t i = 0; i < fb->width * fb->height; i++)
+        fb->data[i] = rgb_scale(fb->data[i], 255 - scale);
+
+    return ESP_OK;
+}
+
+// every pixel keeps 255 - amount of itself and seeps amount / 2 to both
+// neighbours in a line of `count` pixels `step` apart
+static void blur_line(rgb_t *line, size_t count, size_t step, uint8_t amount)
+{
+    uint8_t keep = 255 - amount;
+    uint8_t seep = amount >> 1;
+    rgb_t carryover = { 0 };
+
+    for (size_t i = 0; i < count; i++)
+    {
+        rgb_t cur = line[i * step];
+        rgb_t part = rgb_scale(cur, seep);
+        cur = rgb_add_rgb(rgb_scale(cur, keep), carryover);
+        if (i)
+            line[(i - 1) * step] = rgb_add_rgb(line[(i - 1) * step], part);
+        line[i * step] = cur;
+        carryover = part;
+    }
+}
+
+esp_err_t fb_blur2d(framebuffer_t *fb, uint8_t amount)
+{
+    CHECK_ARG(fb);
+
+    for (size_t y = 0; y < fb->height; y++)
+        blur_line(fb->data + FB_OFFSET(fb, 0, y), fb->width, 1, amount);
+    for (size_t x = 0; x < fb->width; x++)
+        blur_line(fb->data + x, fb->height, fb->width, amount);
+
+    return ESP_OK;
+}
+
+esp_err_t fb_shift(framebuffer_t *fb, size_t offset, fb_shift_direction_t dir)
+{
+    CHECK_ARG(fb && dir <= FB_SHIFT_RIGHT);
+
+    size_t w = fb->width, h = fb->height;
+    size_t limit = dir <= FB_SHIFT_DOWN ? h : w;
+    if (offset > limit)
+        offset = limit;
+
+    // down is toward row 0, vacated pixels keep their values
+    switch (dir)
+    {
+        case FB_SHIFT_UP:
+            memmove(fb->data + offset * w, fb->data, (h - offset) * w * sizeof(rgb_t));
+            break;
+        case FB_SHIFT_DOWN:
+            memmove(fb->data, fb->data + offset * w, (h - offset) * w * sizeof(rgb_t));
+            break;
+        case FB_SHIFT_LEFT:
+            for (size_t y = 0; y < h; y++)
+                memmove(fb->data + FB_OFFSET(fb, 0, y), fb->data + FB_OFFSET(fb, offset, y),
+                        (w - offset) * sizeof(rgb_t));
+            break;
+        case FB_SHIFT_RIGHT:
+            for (size_t y = 0; y < h; y++)
+                memmove(fb->data + FB_OFFSET(fb, offset, y), fb->data + FB_OFFSET(fb, 0, y),
+                        (w - offset) * sizeof(rgb_t));
+            break;
+    }
+
+    return ESP_OK;
+}
@@ -0,0 +1,63 @@
+/**
+ * @file framebuffer.h
+ *
+ * Minimal stand-in for the esp-idf-lib framebuffer component, used when
+ * esp-idf-lib is not available
+ */
+#ifndef __HOST_FRAMEBUFFER_H__
+#define __HOST_FRAMEBUFFER_H__
+
+#include <esp_err.h>
+#include <freertos/semphr.h>
+#include <color.h>
+
+#define FB_OFFSET(fb, x, y) ((y) * (fb)->width + (x))
+
+typedef enum {
+    FB_SHIFT_UP = 0,
+    FB_SHIFT_DOWN,
+    FB_SHIFT_LEFT,
+    FB_SHIFT_RIGHT,
+} fb_shift_direction_t;
+
+typedef struct framebuffer_s framebuffer_t;
+
+typedef esp_err_t (*fb_render_cb_t)(framebuffer_t *fb, void *render_ctx);
+
+struct framebuffer_s
+{
+    size_t width;
+    size_t height;
+    rgb_t *data;
+    void *internal;
+    size_t frame_num;
+    uint64_t last_frame_us;
+    SemaphoreHandle_t mutex;
+    fb_render_cb_t render;
+};
+
+esp_err_t fb_init(framebuffer_t *fb, size_t width, size_t height, fb_render_cb_t render_cb);
+
+esp_err_t fb_free(framebuffer_t *fb);
+
+esp_err_t fb_begin(framebuffer_t *fb);
+
+esp_err_t fb_end(framebuffer_t *fb);
+
+esp_err_t fb_render(framebuffer_t *fb, void *render_ctx);
+
+esp_err_t fb_clear(framebuffer_t *fb);
+
+esp_err_t fb_set_pixel_rgb(framebuffer_t *fb, size_t x, size_t y, rgb_t color);
+
+esp_err_t fb_get_pixel_rgb(framebuffer_t *fb, size_t x, size_t y, rgb_t *color);
+
+esp_err_t fb_set_pixel_hsv(framebuffer_t *fb, size_t x, size_t y, hsv_t color);
+
+esp_err_t fb_fade(framebuffer_t *fb, uint8_t scale);
+
+esp_err_t fb_blur2d(framebuffer_t *fb, uint8_t amount);
+
+esp_err_t fb_shift(framebuffer_t *fb, size_t offset, fb_shift_direction_t dir);
+
+#endif /* __HOST_FRAMEBUFFER_H__ */
@@ -0,0 +1,30 @@
+/**
+ * @file lib8tion.c
+ *
+ * Minimal stand-in for the esp-idf-lib lib8tion component
+ */
+#include <lib8tion.h>
+
+// base and slope of the four sections of a quarter wave
+static const uint8_t b_m16_interleave[] = { 0, 49, 49, 41, 90, 27, 117, 10 };
+
+uint8_t sin8(uint8_t theta)
+{
+    uint8_t offset = theta;
+    if (theta & 0x40)
+        offset = 255 - offset;
+    offset &= 0x3f;
+
+    uint8_t secoffset = offset & 0x0f;
+    if (theta & 0x40)
+        secoffset++;
+
+    const uint8_t *p = b_m16_interleave + (offset >> 4) * 2;
+    uint8_t mx = (p[1] * secoffset) >> 4;
+
+    int8_t y = mx + p[0];
+    if (theta & 0x80)
+        y = -y;
+
+    return y + 128;
+}
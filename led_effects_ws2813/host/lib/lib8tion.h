@@ -0,0 +1,52 @@
+/**
+ * @file lib8tion.h
+ *
+ * Minimal stand-in for the esp-idf-lib lib8tion component, same results
+ * as the FastLED functions effects use, used when esp-idf-lib is not
+ * available
+ */
+#ifndef __HOST_LIB8TION_H__
+#define __HOST_LIB8TION_H__
+
+#include <stdint.h>
+#include <color.h>
+
+static inline uint8_t scale8(uint8_t i, uint8_t scale)
+{
+    return ((uint16_t)i * (1 + (uint16_t)scale)) >> 8;
+}
+
+static inline uint8_t scale8_video(uint8_t i, uint8_t scale)
+{
+    return (((uint16_t)i * scale) >> 8) + ((i && scale) ? 1 : 0);
+}
+
+static inline uint8_t qadd8(uint8_t i, uint8_t j)
+{
+    unsigned t = i + j;
+    return t > 255 ? 255 : t;
+}
+
+static inline uint8_t qsub8(uint8_t i, uint8_t j)
+{
+    return i > j ? i - j : 0;
+}
+
+static inline uint8_t abs8(int8_t i)
+{
+    return i < 0 ? -i : i;
+}
+
+static inline uint8_t lerp8by8(uint8_t a, uint8_t b, uint8_t frac)
+{
+    return b > a ? a + scale8(b - a, frac) : a - scale8(a - b, frac);
+}
+
+uint8_t sin8(uint8_t theta);
+
+static inline uint8_t cos8(uint8_t theta)
+{
+    return sin8(theta + 64);
+}
+
+#endif /* __HOST_LIB8TION_H__ */
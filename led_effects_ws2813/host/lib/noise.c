@@ -0,0 +1,84 @@
+/**
+ * @file noise.c
+ *
+ * Minimal stand-in for the esp-idf-lib noise component
+ */
+#include <lib8tion.h>
+#include <noise.h>
+
+// Ken Perlin's permutation table
+static const uint8_t p[] = {
+    151, 160, 137, 91, 90, 15, 131, 13, 201, 95, 96, 53, 194, 233, 7, 225,
+    140, 36, 103, 30, 69, 142, 8, 99, 37, 240, 21, 10, 23, 190, 6, 148,
+    247, 120, 234, 75, 0, 26, 197, 62, 94, 252, 219, 203, 117, 35, 11, 32,
+    57, 177, 33, 88, 237, 149, 56, 87, 174, 20, 125, 136, 171, 168, 68, 175,
+    74, 165, 71, 134, 139, 48, 27, 166, 77, 146, 158, 231, 83, 111, 229, 122,
+    60, 211, 133, 230, 220, 105, 92, 41, 55, 46, 245, 40, 244, 102, 143, 54,
+    65, 25, 63, 161, 1, 216, 80, 73, 209, 76, 132, 187, 208, 89, 18, 169,
+    200, 196, 135, 130, 116, 188, 159, 86, 164, 100, 109, 198, 173, 186, 3, 64,
+    52, 217, 226, 250, 124, 123, 5, 202, 38, 147, 118, 126, 255, 82, 85, 212,
+    207, 206, 59, 227, 47, 16, 58, 17, 182, 189, 28, 42, 223, 183, 170, 213,
+    119, 248, 152, 2, 44, 154, 163, 70, 221, 153, 101, 155, 167, 43, 172, 9,
+    129, 22, 39, 253, 19, 98, 108, 110, 79, 113, 224, 232, 178, 185, 112, 104,
+    218, 246, 97, 228, 251, 34, 242, 193, 238, 210, 144, 12, 191, 179, 162, 241,
+    81, 51, 145, 235, 249, 14, 239, 107, 49, 192, 214, 31, 181, 199, 106, 157,
+    184, 84, 204, 176, 115, 121, 50, 45, 127, 4, 150, 254, 138, 236, 205, 93,
+    222, 114, 67, 29, 24, 72, 243, 141, 128, 195, 78, 66, 215, 61, 156, 180,
+};
+
+#define P(x) p[(uint8_t)(x)]
+
+static uint8_t ease8_in_out_quad(uint8_t i)
+{
+    uint8_t j = i & 0x80 ? 255 - i : i;
+    uint8_t jj2 = scale8(j, j) << 1;
+
+    return i & 0x80 ? 255 - jj2 : jj2;
+}
+
+static int8_t avg7(int8_t i, int8_t j)
+{
+    return (i >> 1) + (j >> 1) + (i & 1);
+}
+
+static int8_t lerp7by8(int8_t a, int8_t b, uint8_t frac)
+{
+    return b > a ? a + scale8(b - a, frac) : a - scale8(a - b, frac);
+}
+
+static int8_t grad8(uint8_t hash, int8_t x, int8_t y, int8_t z)
+{
+    hash &= 0xf;
+    int8_t u = hash & 8 ? y : x;
+    int8_t v = hash < 4 ? y : hash == 12 || hash == 14 ? x : z;
+    if (hash & 1)
+        u = -u;
+    if (hash & 2)
+        v = -v;
+
+    return avg7(u, v);
+}
+
+uint8_t inoise8_3d(uint16_t x, uint16_t y, uint16_t z)
+{
+    // hash the corners of the unit cube with the point
+    uint8_t X = x >> 8, Y = y >> 8, Z = z >> 8;
+    uint8_t A = P(X) + Y, AA = P(A) + Z, AB = P(A + 1) + Z;
+    uint8_t B = P(X + 1) + Y, BA = P(B) + Z, BB = P(B + 1) + Z;
+
+    // position in the cube, signed for grad8()
+    int8_t xx = ((uint8_t)x >> 1) & 0x7f;
+    int8_t yy = ((uint8_t)y >> 1) & 0x7f;
+    int8_t zz = ((uint8_t)z >> 1) & 0x7f;
+    const uint8_t N = 0x80;
+    uint8_t u = ease8_in_out_quad(x), v = ease8_in_out_quad(y), w = ease8_in_out_quad(z);
+
+    int8_t x1 = lerp7by8(grad8(P(AA), xx, yy, zz), grad8(P(BA), xx - N, yy, zz), u);
+    int8_t x2 = lerp7by8(grad8(P(AB), xx, yy - N, zz), grad8(P(BB), xx - N, yy - N, zz), u);
+    int8_t x3 = lerp7by8(grad8(P(AA + 1), xx, yy, zz - N), grad8(P(BA + 1), xx - N, yy, zz - N), u);
+    int8_t x4 = lerp7by8(grad8(P(AB + 1), xx, yy - N, zz - N), grad8(P(BB + 1), xx - N, yy - N, zz - N), u);
+    int8_t n = lerp7by8(lerp7by8(x1, x2, v), lerp7by8(x3, x4, v), w);
+
+    // -64..64 to 0..255
+    return qadd8(n + 64, n + 64);
+}
@@ -0,0 +1,14 @@
+/**
+ * @file noise.h
+ *
+ * Minimal stand-in for the esp-idf-lib noise component, FastLED 8-bit
+ * Perlin noise, used when esp-idf-lib is not available
+ */
+#ifndef __HOST_NOISE_H__
+#define __HOST_NOISE_H__
+
+#include <stdint.h>
+
+uint8_t inoise8_3d(uint16_t x, uint16_t y, uint16_t z);
+
+#endif /* __HOST_NOISE_H__ */
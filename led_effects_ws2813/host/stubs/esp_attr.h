@@ -0,0 +1,12 @@
+/**
+ * @file esp_attr.h
+ *
+ * Host stand-in: memory placement attributes are no-ops
+ */
+#ifndef __HOST_ESP_ATTR_H__
+#define __HOST_ESP_ATTR_H__
+
+#define IRAM_ATTR
+#define DRAM_ATTR
+
+#endif /* __HOST_ESP_ATTR_H__ */
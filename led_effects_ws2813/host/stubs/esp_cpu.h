@@ -0,0 +1,14 @@
+/**
+ * @file esp_cpu.h
+ *
+ * Host stand-in: cycle counter derived from monotonic time at
+ * HOST_CPU_FREQ_MHZ, so cycle figures are comparable with the device
+ */
+#ifndef __HOST_ESP_CPU_H__
+#define __HOST_ESP_CPU_H__
+
+#include <stdint.h>
+
+uint32_t esp_cpu_get_ccount(void);
+
+#endif /* __HOST_ESP_CPU_H__ */
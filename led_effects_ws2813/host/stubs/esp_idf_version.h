@@ -0,0 +1,12 @@
+/**
+ * @file esp_idf_version.h
+ *
+ * Host stand-in: version the firmware is built with
+ */
+#ifndef __HOST_ESP_IDF_VERSION_H__
+#define __HOST_ESP_IDF_VERSION_H__
+
+#define ESP_IDF_VERSION_VAL(major, minor, patch) (((major) << 16) | ((minor) << 8) | (patch))
+#define ESP_IDF_VERSION ESP_IDF_VERSION_VAL(4, 4, 0)
+
+#endif /* __HOST_ESP_IDF_VERSION_H__ */
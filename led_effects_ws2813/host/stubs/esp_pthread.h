@@ -0,0 +1,11 @@
+/**
+ * @file esp_pthread.h
+ *
+ * Host stand-in: thread placement is left to the OS
+ */
+#ifndef __HOST_ESP_PTHREAD_H__
+#define __HOST_ESP_PTHREAD_H__
+
+#include <esp_err.h>
+
+#endif /* __HOST_ESP_PTHREAD_H__ */
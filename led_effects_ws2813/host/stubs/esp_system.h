@@ -0,0 +1,13 @@
+/**
+ * @file esp_system.h
+ *
+ * Host stand-in: random numbers
+ */
+#ifndef __HOST_ESP_SYSTEM_H__
+#define __HOST_ESP_SYSTEM_H__
+
+#include <stdint.h>
+
+uint32_t esp_random(void);
+
+#endif /* __HOST_ESP_SYSTEM_H__ */
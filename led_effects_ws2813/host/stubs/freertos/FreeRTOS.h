@@ -0,0 +1,28 @@
+/**
+ * @file FreeRTOS.h
+ *
+ * Host stand-in: FreeRTOS types, one tick is one millisecond
+ */
+#ifndef __HOST_FREERTOS_H__
+#define __HOST_FREERTOS_H__
+
+#include <esp_err.h>
+#include <sdkconfig.h>
+
+typedef uint32_t TickType_t;
+typedef int BaseType_t;
+typedef unsigned UBaseType_t;
+
+#define pdTRUE  1
+#define pdFALSE 0
+#define pdPASS  pdTRUE
+#define pdFAIL  pdFALSE
+
+#define portMAX_DELAY      ((TickType_t)0xffffffff)
+#define portTICK_PERIOD_MS (1000 / CONFIG_FREERTOS_HZ)
+#define pdMS_TO_TICKS(ms)  ((TickType_t)(ms) / portTICK_PERIOD_MS)
+
+#define portNUM_PROCESSORS 2
+#define tskNO_AFFINITY     0x7fffffff
+
+#endif /* __HOST_FREERTOS_H__ */
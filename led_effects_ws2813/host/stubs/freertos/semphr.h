@@ -0,0 +1,23 @@
+/**
+ * @file semphr.h
+ *
+ * Host stand-in: mutexes and binary semaphores on pthreads
+ */
+#ifndef __HOST_FREERTOS_SEMPHR_H__
+#define __HOST_FREERTOS_SEMPHR_H__
+
+#include <freertos/FreeRTOS.h>
+
+typedef struct host_semaphore *SemaphoreHandle_t;
+
+SemaphoreHandle_t xSemaphoreCreateMutex(void);
+
+SemaphoreHandle_t xSemaphoreCreateBinary(void);
+
+BaseType_t xSemaphoreTake(SemaphoreHandle_t sem, TickType_t ticks);
+
+BaseType_t xSemaphoreGive(SemaphoreHandle_t sem);
+
+void vSemaphoreDelete(SemaphoreHandle_t sem);
+
+#endif /* __HOST_FREERTOS_SEMPHR_H__ */
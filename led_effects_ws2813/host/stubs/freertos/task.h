@@ -0,0 +1,13 @@
+/**
+ * @file task.h
+ *
+ * Host stand-in: task delays
+ */
+#ifndef __HOST_FREERTOS_TASK_H__
+#define __HOST_FREERTOS_TASK_H__
+
+#include <freertos/FreeRTOS.h>
+
+void vTaskDelay(TickType_t ticks);
+
+#endif /* __HOST_FREERTOS_TASK_H__ */
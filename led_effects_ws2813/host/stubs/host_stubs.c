@@ -0,0 +1,149 @@
+/**
+ * @file host_stubs.c
+ *
+ * Host stand-ins for the ESP-IDF and FreeRTOS calls used by the
+ * driver-free parts of the example
+ */
+#include <time.h>
+#include <errno.h>
+#include <pthread.h>
+#include <esp_timer.h>
+#include <esp_system.h>
+#include <esp_cpu.h>
+#include <freertos/task.h>
+#include <freertos/semphr.h>
+
+#define HOST_CPU_FREQ_MHZ CONFIG_ESP32_DEFAULT_CPU_FREQ_MHZ
+
+struct host_semaphore
+{
+    pthread_mutex_t mutex;
+    pthread_cond_t cond;
+    bool available;
+};
+
+static uint64_t now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+int64_t esp_timer_get_time(void)
+{
+    return now_ns() / 1000;
+}
+
+esp_err_t esp_timer_create(const esp_timer_create_args_t *args, esp_timer_handle_t *timer)
+{
+    return ESP_ERR_NOT_SUPPORTED;
+}
+
+esp_err_t esp_timer_start_once(esp_timer_handle_t timer, uint64_t timeout_us)
+{
+    return ESP_ERR_NOT_SUPPORTED;
+}
+
+esp_err_t esp_timer_stop(esp_timer_handle_t timer)
+{
+    return ESP_ERR_NOT_SUPPORTED;
+}
+
+esp_err_t esp_timer_delete(esp_timer_handle_t timer)
+{
+    return ESP_ERR_NOT_SUPPORTED;
+}
+
+uint32_t esp_cpu_get_ccount(void)
+{
+    return now_ns() * HOST_CPU_FREQ_MHZ / 1000;
+}
+
+uint32_t esp_random(void)
+{
+    static uint32_t state = 0;
+    if (!state)
+        state = (uint32_t)now_ns() | 1;
+
+    // xorshift32
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return state;
+}
+
+void vTaskDelay(TickType_t ticks)
+{
+    struct timespec ts = {
+        .tv_sec = ticks * portTICK_PERIOD_MS / 1000,
+        .tv_nsec = (long)(ticks * portTICK_PERIOD_MS % 1000) * 1000000,
+    };
+    nanosleep(&ts, NULL);
+}
+
+static SemaphoreHandle_t create(bool available)
+{
+    SemaphoreHandle_t sem = calloc(1, sizeof(struct host_semaphore));
+    if (!sem)
+        return NULL;
+
+    pthread_mutex_init(&sem->mutex, NULL);
+    pthread_cond_init(&sem->cond, NULL);
+    sem->available = available;
+    return sem;
+}
+
+SemaphoreHandle_t xSemaphoreCreateMutex(void)
+{
+    return create(true);
+}
+
+SemaphoreHandle_t xSemaphoreCreateBinary(void)
+{
+    return create(false);
+}
+
+BaseType_t xSemaphoreTake(SemaphoreHandle_t sem, TickType_t ticks)
+{
+    struct timespec deadline;
+    clock_gettime(CLOCK_REALTIME, &deadline);
+    uint64_t ns = deadline.tv_nsec + (uint64_t)ticks * portTICK_PERIOD_MS * 1000000;
+    deadline.tv_sec += ns / 1000000000;
+    deadline.tv_nsec = ns % 1000000000;
+
+    pthread_mutex_lock(&sem->mutex);
+    int res = 0;
+    while (!sem->available && res != ETIMEDOUT)
+    {
+        if (ticks == portMAX_DELAY)
+            pthread_cond_wait(&sem->cond, &sem->mutex);
+        else
+            res = pthread_cond_timedwait(&sem->cond, &sem->mutex, &deadline);
+    }
+    bool taken = sem->available;
+    sem->available = false;
+    pthread_mutex_unlock(&sem->mutex);
+
+    return taken ? pdTRUE : pdFALSE;
+}
+
+BaseType_t xSemaphoreGive(SemaphoreHandle_t sem)
+{
+    pthread_mutex_lock(&sem->mutex);
+    bool given = !sem->available;
+    sem->available = true;
+    pthread_cond_signal(&sem->cond);
+    pthread_mutex_unlock(&sem->mutex);
+
+    return given ? pdTRUE : pdFALSE;
+}
+
+void vSemaphoreDelete(SemaphoreHandle_t sem)
+{
+    if (!sem)
+        return;
+
+    pthread_cond_destroy(&sem->cond);
+    pthread_mutex_destroy(&sem->mutex);
+    free(sem);
+}
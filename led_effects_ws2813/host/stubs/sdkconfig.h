@@ -0,0 +1,15 @@
+/**
+ * @file sdkconfig.h
+ *
+ * Host stand-in: options the host build needs, the example options
+ * are defined by host/CMakeLists.txt
+ */
+#ifndef __HOST_SDKCONFIG_H__
+#define __HOST_SDKCONFIG_H__
+
+#define CONFIG_IDF_TARGET_ESP32 1
+#define CONFIG_IDF_TARGET "esp32"
+#define CONFIG_FREERTOS_HZ 1000
+#define CONFIG_ESP32_DEFAULT_CPU_FREQ_MHZ 240
+
+#endif /* __HOST_SDKCONFIG_H__ */
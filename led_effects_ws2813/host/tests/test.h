@@ -0,0 +1,21 @@
+/**
+ * @file test.h
+ *
+ * Assertions for host tests
+ */
+#ifndef __HOST_TEST_H__
+#define __HOST_TEST_H__
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#define TEST_ASSERT(x) do { \
+        if (!(x)) { \
+            fprintf(stderr, "%s:%d: assertion failed: %s\n", __FILE__, __LINE__, #x); \
+            exit(EXIT_FAILURE); \
+        } \
+    } while (0)
+
+#define TEST_OK(x) TEST_ASSERT((x) == ESP_OK)
+
+#endif /* __HOST_TEST_H__ */
@@ -0,0 +1,63 @@
+/**
+ * @file test_arena.c
+ *
+ * Any number of framebuffers have arenas attached, effect state of every
+ * framebuffer comes from its own arena
+ */
+#include "effects/effect.h"
+#include "test.h"
+
+#define FBS        9 // two slots of four zones and one more
+#define ARENA_SIZE 1024
+
+static esp_err_t null_render(framebuffer_t *fb, void *arg)
+{
+    return ESP_OK;
+}
+
+static bool in(const led_effect_arena_t *arena, const void *ptr)
+{
+    return ptr && (const uint8_t *)ptr >= arena->base && (const uint8_t *)ptr < arena->base + arena->size;
+}
+
+int main(void)
+{
+    static uint8_t bufs[FBS][ARENA_SIZE] __attribute__((aligned(LED_EFFECT_ALIGN)));
+    static led_effect_arena_t arenas[FBS];
+    framebuffer_t fbs[FBS];
+
+    for (size_t i = 0; i < FBS; i++)
+    {
+        TEST_OK(fb_init(&fbs[i], 4, 4, null_render));
+        TEST_OK(led_effect_arena_init(&arenas[i], bufs[i], ARENA_SIZE));
+        TEST_OK(led_effect_arena_attach(&fbs[i], &arenas[i]));
+    }
+    for (size_t i = 0; i < FBS; i++)
+    {
+        void *ptr = led_effect_alloc(&fbs[i], 16);
+        TEST_ASSERT(in(&arenas[i], ptr));
+        led_effect_free(&fbs[i], ptr);
+    }
+
+    // moving an arena to another framebuffer replaces its arena
+    TEST_OK(led_effect_arena_attach(&fbs[0], &arenas[1]));
+    TEST_ASSERT(in(&arenas[1], led_effect_alloc(&fbs[0], 16)));
+    void *ptr = led_effect_alloc(&fbs[1], 16);
+    TEST_ASSERT(ptr && !in(&arenas[1], ptr) && !in(&arenas[0], ptr));
+    led_effect_free(&fbs[1], ptr);
+
+    // detached framebuffer allocates from heap
+    TEST_OK(led_effect_arena_attach(&fbs[5], NULL));
+    ptr = led_effect_alloc(&fbs[5], 16);
+    TEST_ASSERT(ptr && !in(&arenas[5], ptr));
+    led_effect_free(&fbs[5], ptr);
+    TEST_ASSERT(in(&arenas[6], led_effect_alloc(&fbs[6], 16)));
+
+    for (size_t i = 0; i < FBS; i++)
+    {
+        TEST_OK(led_effect_arena_attach(&fbs[i], NULL));
+        fb_free(&fbs[i]);
+    }
+
+    return 0;
+}
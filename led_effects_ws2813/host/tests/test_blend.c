@@ -0,0 +1,58 @@
+/**
+ * @file test_blend.c
+ *
+ * Word path of blend_rgb() gives the same bytes as the byte path
+ */
+#include <string.h>
+
+#include "player/blend.h"
+#include "test.h"
+
+#define PIXELS 37 // tail of the word path is blended byte by byte
+#define SIZE   (PIXELS * sizeof(rgb_t))
+
+int main(void)
+{
+    // one byte more, so the frames can be misaligned to take the byte path
+    static uint32_t a[SIZE / 4 + 2], b[SIZE / 4 + 2], word[SIZE / 4 + 2], bytes[SIZE / 4 + 2];
+    uint8_t *pa = (uint8_t *)a, *pb = (uint8_t *)b;
+
+    uint32_t x = 1;
+    for (size_t i = 0; i < SIZE + 1; i++)
+    {
+        // xorshift32, corners of the range included
+        x ^= x << 13;
+        x ^= x >> 17;
+        x ^= x << 5;
+        pa[i] = i < 4 ? 0xff : x;
+        pb[i] = i < 4 ? 0x00 : x >> 8;
+    }
+
+    for (unsigned alpha = 0; alpha < 256; alpha++)
+    {
+        blend_rgb((rgb_t *)word, (const rgb_t *)a, (const rgb_t *)b, PIXELS, alpha);
+
+        // same frames one byte off word alignment
+        memmove(pa + 1, pa, SIZE);
+        memmove(pb + 1, pb, SIZE);
+        blend_rgb((rgb_t *)((uint8_t *)bytes + 1), (const rgb_t *)(pa + 1), (const rgb_t *)(pb + 1), PIXELS, alpha);
+        memmove(pa, pa + 1, SIZE);
+        memmove(pb, pb + 1, SIZE);
+
+        const uint8_t *w = (const uint8_t *)word;
+        const uint8_t *by = (const uint8_t *)bytes + 1;
+        for (size_t i = 0; i < SIZE; i++)
+        {
+            uint8_t expected = (pa[i] * (256 - alpha) + pb[i] * alpha) >> 8;
+            TEST_ASSERT(w[i] == expected);
+            TEST_ASSERT(by[i] == expected);
+        }
+    }
+
+    // blending in place, alpha 0 keeps the first frame as is
+    memcpy(word, a, SIZE);
+    blend_rgb((rgb_t *)word, (const rgb_t *)word, (const rgb_t *)b, PIXELS, 0);
+    TEST_ASSERT(!memcmp(word, a, SIZE));
+
+    return 0;
+}
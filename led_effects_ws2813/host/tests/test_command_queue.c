@@ -0,0 +1,91 @@
+/**
+ * @file test_command_queue.c
+ *
+ * Command queue: capacity, order, and one producer and one consumer
+ * thread pushing and popping as fast as they can
+ */
+#include <string.h>
+#include <pthread.h>
+#include <sched.h>
+
+#include "player/command.h"
+#include "test.h"
+
+#define COUNT 200000
+
+static command_queue_t queue;
+
+// contents of every command follow from its number
+static void test_command(command_t *cmd, uint32_t n)
+{
+    memset(cmd, 0, sizeof(command_t));
+    cmd->type = n;
+    cmd->value = ~n;
+    for (size_t i = 0; i < COMMAND_PARAMS; i++)
+        cmd->params[i] = n >> (i * 8);
+    cmd->sent = (int64_t)n << 16;
+}
+
+static void check_command(const command_t *cmd, uint32_t n)
+{
+    command_t expected;
+    test_command(&expected, n);
+    TEST_ASSERT(cmd->type == expected.type);
+    TEST_ASSERT(cmd->value == expected.value);
+    TEST_ASSERT(!memcmp(cmd->params, expected.params, COMMAND_PARAMS));
+    TEST_ASSERT(cmd->sent == expected.sent);
+}
+
+static void *producer(void *arg)
+{
+    command_t cmd;
+    for (uint32_t n = 0; n < COUNT;)
+    {
+        test_command(&cmd, n);
+        if (command_queue_push(&queue, &cmd))
+            n++;
+        else
+            sched_yield();
+    }
+
+    return NULL;
+}
+
+int main(void)
+{
+    command_t cmd;
+
+    // single thread: full after COMMAND_QUEUE_SIZE commands, FIFO order
+    command_queue_init(&queue);
+    TEST_ASSERT(!command_queue_pop(&queue, &cmd));
+    for (uint32_t n = 0; n < COMMAND_QUEUE_SIZE; n++)
+    {
+        test_command(&cmd, n);
+        TEST_ASSERT(command_queue_push(&queue, &cmd));
+    }
+    TEST_ASSERT(!command_queue_push(&queue, &cmd));
+    for (uint32_t n = 0; n < COMMAND_QUEUE_SIZE; n++)
+    {
+        TEST_ASSERT(command_queue_pop(&queue, &cmd));
+        check_command(&cmd, n);
+    }
+    TEST_ASSERT(!command_queue_pop(&queue, &cmd));
+
+    // two threads, indices wrap around the ring many times
+    command_queue_init(&queue);
+    pthread_t thread;
+    TEST_ASSERT(!pthread_create(&thread, NULL, producer, NULL));
+    for (uint32_t n = 0; n < COUNT;)
+    {
+        if (!command_queue_pop(&queue, &cmd))
+        {
+            sched_yield();
+            continue;
+        }
+        check_command(&cmd, n++);
+    }
+    pthread_join(thread, NULL);
+    TEST_ASSERT(!command_queue_pop(&queue, &cmd));
+
+    return 0;
+}
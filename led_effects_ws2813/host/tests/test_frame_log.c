@@ -0,0 +1,106 @@
+/**
+ * @file test_frame_log.c
+ *
+ * Frames flushed by mock backend end up in frame log
+ */
+#include <string.h>
+
+#include "output/output.h"
+#include "output/backends.h"
+#include "test.h"
+
+#define PANEL_SIZE 4
+#define LANES 2
+#define FRAMES 3
+
+static int64_t now = 0;
+
+static int64_t virtual_clock(void)
+{
+    return now;
+}
+
+static uint32_t get32(const uint8_t *p)
+{
+    return p[0] | p[1] << 8 | p[2] << 16 | (uint32_t)p[3] << 24;
+}
+
+int main(void)
+{
+    static const layout_panel_t panels[LANES] = {
+        { .wiring = LAYOUT_WIRING_PROGRESSIVE, .lane = 0 },
+        { .wiring = LAYOUT_WIRING_PROGRESSIVE, .lane = 1 },
+    };
+    static const layout_t layout = {
+        .panel_width = PANEL_SIZE,
+        .panel_height = PANEL_SIZE,
+        .cols = LANES,
+        .rows = 1,
+        .panels = panels,
+    };
+    output_config_t config = {
+        .backend = &output_backend_mock,
+        .layout = &layout,
+        .brightness = 255,
+        .gamma = 1.0f,
+        .white = { .r = 255, .g = 255, .b = 255 },
+        .channel_current = 50,
+        .num_lanes = LANES,
+    };
+    static output_t out;
+    TEST_OK(output_init(&out, &config));
+
+    FILE *file = tmpfile();
+    TEST_ASSERT(file);
+    static frame_log_t log;
+    TEST_OK(frame_log_init(&log, file, FRAME_LOG_DATA, virtual_clock));
+    output_backend_mock_set_log(&log);
+
+    framebuffer_t fb;
+    TEST_OK(fb_init(&fb, out.width, out.height, output_render));
+    for (size_t frame = 0; frame < FRAMES; frame++)
+    {
+        for (size_t i = 0; i < out.width * out.height; i++)
+            fb.data[i] = rgb_from_values(i, frame, 255 - i);
+        now = frame * 1000;
+        TEST_OK(fb_render(&fb, &out));
+        // unchanged frame is skipped, nothing is logged
+        TEST_OK(fb_render(&fb, &out));
+    }
+    TEST_ASSERT(log.records == FRAMES * LANES);
+    TEST_ASSERT(out.skipped == FRAMES);
+
+    uint8_t header[8];
+    rewind(file);
+    TEST_ASSERT(fread(header, sizeof(header), 1, file) == 1);
+    TEST_ASSERT(!memcmp(header, FRAME_LOG_MAGIC, 4));
+
+    uint8_t data[LANES][PANEL_SIZE * PANEL_SIZE * OUTPUT_COLOR_SIZE];
+    for (size_t r = 0; r < log.records; r++)
+    {
+        uint8_t record[24];
+        TEST_ASSERT(fread(record, sizeof(record), 1, file) == 1);
+        size_t lane = record[8] | record[9] << 8;
+        uint32_t frame = get32(record + 12);
+        uint32_t size = get32(record + 16);
+        TEST_ASSERT(lane == r % LANES);
+        TEST_ASSERT(frame == r / LANES + 1);
+        TEST_ASSERT(get32(record) == r / LANES * 1000);
+        TEST_ASSERT(size == sizeof(data[lane]));
+        TEST_ASSERT(fread(data[lane], size, 1, file) == 1);
+        TEST_ASSERT(get32(record + 20) == frame_log_checksum(data[lane], size));
+    }
+    // last records hold what the lanes show
+    for (size_t l = 0; l < LANES; l++)
+    {
+        TEST_ASSERT(output_backend_mock_frames(&out.lanes[l]) == FRAMES);
+        TEST_ASSERT(!memcmp(data[l], output_backend_mock_data(&out.lanes[l]), sizeof(data[l])));
+    }
+
+    output_backend_mock_set_log(NULL);
+    fclose(file);
+    fb_free(&fb);
+    TEST_OK(output_free(&out));
+
+    return 0;
+}
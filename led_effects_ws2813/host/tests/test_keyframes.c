@@ -0,0 +1,121 @@
+/**
+ * @file test_keyframes.c
+ *
+ * Keyframes are computed a share of rows per frame, interpolated frames
+ * follow the effect time at any frame rate, errors release the
+ * framebuffer
+ */
+#include "effects/keyframes.h"
+#include "effects/tiles.h"
+#include "player/blend.h"
+#include "test.h"
+
+#define WIDTH    4
+#define HEIGHT   8
+#define INTERVAL 3
+
+static int64_t now_us;
+static led_effect_clock_t ramp_clock;
+static size_t rows_rendered;
+static bool fail;
+
+static int64_t virtual_time(void)
+{
+    return now_us;
+}
+
+static esp_err_t ramp_begin(framebuffer_t *fb)
+{
+    return led_effect_begin(fb, &ramp_clock);
+}
+
+// every pixel is the effect time in 10 ms of the keyframe
+static esp_err_t ramp_rows(framebuffer_t *fb, size_t y0, size_t y1)
+{
+    if (fail)
+        return ESP_FAIL;
+    for (size_t y = y0; y < y1; y++)
+        for (size_t x = 0; x < fb->width; x++)
+            fb->data[FB_OFFSET(fb, x, y)] = rgb_from_values(ramp_clock.ms / 10, 0, 0);
+    rows_rendered += y1 - y0;
+
+    return ESP_OK;
+}
+
+static const led_effect_t ramp = {
+    .name = "ramp",
+    .begin = ramp_begin,
+    .rows = ramp_rows,
+    .keyframe_interval = INTERVAL,
+    .cycles_per_pixel = 100,
+};
+
+static esp_err_t null_render(framebuffer_t *fb, void *arg)
+{
+    return ESP_OK;
+}
+
+// renders frames `dt` apart, returns shown value of the last one
+static uint8_t run(framebuffer_t *fb, led_effect_keyframes_t *kf, size_t frames, int64_t dt, uint8_t prev, bool steady)
+{
+    for (size_t f = 0; f < frames; f++)
+    {
+        now_us += dt;
+        rows_rendered = 0;
+        TEST_OK(led_effect_keyframes_render(fb, &ramp, kf));
+        // no frame computes more than its share of a keyframe
+        TEST_ASSERT(rows_rendered <= (HEIGHT + INTERVAL - 1) / INTERVAL);
+        // blend rounds down, a step may be late by one
+        uint8_t v = fb->data[0].r;
+        TEST_ASSERT(v >= prev && (!steady || v - prev <= 2));
+        prev = v;
+    }
+
+    return prev;
+}
+
+int main(void)
+{
+    framebuffer_t fb;
+    led_effect_keyframes_t kf;
+
+    led_effect_set_time_source(virtual_time);
+    TEST_OK(fb_init(&fb, WIDTH, HEIGHT, null_render));
+    TEST_OK(led_effect_keyframes_init(&fb, &kf, &ramp_clock, INTERVAL));
+    if (!kf.keys)
+        return 0; // built without keyframes
+
+    // black until the first keyframe is complete
+    for (size_t f = 0; f < INTERVAL - 1; f++)
+    {
+        now_us += 10000;
+        TEST_OK(led_effect_keyframes_render(&fb, &ramp, &kf));
+        TEST_ASSERT(fb.data[0].r == 0 && fb.data[0].g == 0 && fb.data[0].b == 0);
+    }
+
+    // at 100 FPS the ramp moves by one per frame, at 200 FPS by one per two
+    uint8_t v = run(&fb, &kf, 30, 10000, 0, true);
+    uint8_t v100 = run(&fb, &kf, 60, 10000, v, true);
+    TEST_ASSERT(v100 - v >= 58 && v100 - v <= 62);
+
+    // keyframes already computed at the old rate may skip a step or two
+    v = run(&fb, &kf, 2 * INTERVAL, 5000, v100, false);
+    uint8_t v200 = run(&fb, &kf, 120, 5000, v, true);
+    TEST_ASSERT(v200 - v >= 58 && v200 - v <= 62);
+
+    // an error of the effect doesn't leave the framebuffer locked
+    fail = true;
+    TEST_ASSERT(led_effect_keyframes_render(&fb, &ramp, &kf) == ESP_FAIL);
+    TEST_ASSERT(xSemaphoreTake(fb.mutex, 0));
+    xSemaphoreGive(fb.mutex);
+    fail = false;
+
+    // peak cost is a share of a keyframe and a blend
+    TEST_ASSERT(led_effect_frame_cycles(&ramp, WIDTH, HEIGHT)
+            == 100 * WIDTH * 3 + BLEND_CYCLES_PER_PIXEL * WIDTH * HEIGHT);
+
+    TEST_OK(led_effect_keyframes_done(&fb, &kf));
+    fb_free(&fb);
+
+    return 0;
+}
@@ -0,0 +1,99 @@
+/**
+ * @file test_lanes.c
+ *
+ * Framebuffer is split between lanes by layout, every lane gets the
+ * pixels of its own panels in chain order
+ */
+#include <string.h>
+
+#include "output/output.h"
+#include "output/backends.h"
+#include "test.h"
+
+#define PANEL_WIDTH  4
+#define PANEL_HEIGHT 2
+#define PANEL_LEDS   (PANEL_WIDTH * PANEL_HEIGHT)
+#define LANES        3
+
+// LED `led` of `lane` shows pixel x, y
+static void check_pixel(const output_t *out, size_t lane, size_t led, size_t x, size_t y)
+{
+    const uint8_t *data = output_backend_mock_data(&out->lanes[lane]) + led * OUTPUT_COLOR_SIZE;
+    // GRB, color of pixel is its coordinates
+    TEST_ASSERT(data[0] == y + 1);
+    TEST_ASSERT(data[1] == x + 1);
+    TEST_ASSERT(data[2] == lane + 1);
+}
+
+int main(void)
+{
+    // top row chained on lane 0 from the right, bottom panels on lanes 1 and 2
+    static const layout_panel_t panels[] = {
+        { .wiring = LAYOUT_WIRING_PROGRESSIVE, .lane = 0, .position = 1 },
+        { .wiring = LAYOUT_WIRING_PROGRESSIVE, .lane = 0, .position = 0 },
+        { .wiring = LAYOUT_WIRING_PROGRESSIVE, .lane = 1 },
+        { .wiring = LAYOUT_WIRING_PROGRESSIVE, .lane = 2 },
+    };
+    static const layout_t layout = {
+        .panel_width = PANEL_WIDTH,
+        .panel_height = PANEL_HEIGHT,
+        .cols = 2,
+        .rows = 2,
+        .panels = panels,
+    };
+    output_config_t config = {
+        .backend = &output_backend_mock,
+        .layout = &layout,
+        .brightness = 255,
+        .gamma = 1.0f,
+        .white = { .r = 255, .g = 255, .b = 255 },
+        .channel_current = 50,
+        .num_lanes = LANES,
+    };
+    static output_t out;
+    TEST_OK(output_init(&out, &config));
+
+    TEST_ASSERT(out.lanes[0].length == 2 * PANEL_LEDS);
+    TEST_ASSERT(out.lanes[1].length == PANEL_LEDS);
+    TEST_ASSERT(out.lanes[2].length == PANEL_LEDS);
+    // lanes follow each other in frame buffer
+    TEST_ASSERT(out.lanes[0].offset == 0);
+    TEST_ASSERT(out.lanes[1].offset == 2 * PANEL_LEDS * OUTPUT_COLOR_SIZE);
+    TEST_ASSERT(out.lanes[2].offset == 3 * PANEL_LEDS * OUTPUT_COLOR_SIZE);
+
+    framebuffer_t fb;
+    TEST_OK(fb_init(&fb, out.width, out.height, output_render));
+    for (size_t y = 0; y < out.height; y++)
+        for (size_t x = 0; x < out.width; x++)
+        {
+            size_t lane = y < PANEL_HEIGHT ? 0 : 1 + x / PANEL_WIDTH;
+            fb.data[FB_OFFSET(&fb, x, y)] = rgb_from_values(x + 1, y + 1, lane + 1);
+        }
+    TEST_OK(fb_render(&fb, &out));
+
+    for (size_t l = 0; l < LANES; l++)
+        TEST_ASSERT(output_backend_mock_frames(&out.lanes[l]) == 1);
+
+    for (size_t y = 0; y < PANEL_HEIGHT; y++)
+        for (size_t x = 0; x < PANEL_WIDTH; x++)
+        {
+            size_t led = y * PANEL_WIDTH + x;
+            // right panel is the first one of lane 0
+            check_pixel(&out, 0, led, PANEL_WIDTH + x, y);
+            check_pixel(&out, 0, PANEL_LEDS + led, x, y);
+            check_pixel(&out, 1, led, x, PANEL_HEIGHT + y);
+            check_pixel(&out, 2, led, PANEL_WIDTH + x, PANEL_HEIGHT + y);
+        }
+
+    fb_free(&fb);
+    TEST_OK(output_free(&out));
+
+    // failed color tables free lanes and buffers
+    config.gamma = 0;
+    TEST_ASSERT(output_init(&out, &config) == ESP_ERR_INVALID_ARG);
+    TEST_ASSERT(!out.map && !out.front && !out.back);
+    for (size_t l = 0; l < LANES; l++)
+        TEST_ASSERT(!out.lanes[l].ctx);
+
+    return 0;
+}
@@ -0,0 +1,79 @@
+/**
+ * @file test_layout.c
+ *
+ * Layout compiler: rotation, mirroring and serpentine wiring of a panel
+ */
+#include <string.h>
+
+#include "output/layout.h"
+#include "test.h"
+
+#define W 3
+#define H 2
+
+// LED index of every pixel of a single 3x2 panel, row by row
+static void check_panel(layout_rotation_t rotation, bool flip, layout_wiring_t wiring, const uint32_t expected[W * H])
+{
+    const layout_panel_t panel = { .rotation = rotation, .flip = flip, .wiring = wiring };
+    const layout_t layout = { .panel_width = W, .panel_height = H, .cols = 1, .rows = 1, .panels = &panel };
+    const size_t offsets[1] = { 0 };
+    uint32_t map[W * H];
+
+    TEST_OK(layout_check(&layout, 1));
+    TEST_OK(layout_compile(&layout, offsets, 1, map));
+    for (size_t i = 0; i < W * H; i++)
+        if (map[i] != expected[i])
+        {
+            fprintf(stderr, "rotation %d, flip %d, wiring %d: pixel %zu is LED %u, expected %u\n",
+                    rotation, flip, wiring, i, map[i], expected[i]);
+            exit(EXIT_FAILURE);
+        }
+}
+
+int main(void)
+{
+    static const uint32_t progressive[] = { 0, 1, 2, 3, 4, 5 };
+    static const uint32_t serpentine[] = { 0, 1, 2, 5, 4, 3 };
+    static const uint32_t flipped[] = { 2, 1, 0, 5, 4, 3 };
+    static const uint32_t rotated_90[] = { 4, 2, 0, 5, 3, 1 };
+    static const uint32_t rotated_180[] = { 5, 4, 3, 2, 1, 0 };
+    static const uint32_t rotated_270[] = { 1, 3, 5, 0, 2, 4 };
+    static const uint32_t serpentine_90[] = { 4, 3, 0, 5, 2, 1 };
+    static const uint32_t flipped_90[] = { 0, 2, 4, 1, 3, 5 };
+
+    check_panel(LAYOUT_ROTATE_0, false, LAYOUT_WIRING_PROGRESSIVE, progressive);
+    check_panel(LAYOUT_ROTATE_0, false, LAYOUT_WIRING_SERPENTINE, serpentine);
+    check_panel(LAYOUT_ROTATE_0, true, LAYOUT_WIRING_PROGRESSIVE, flipped);
+    check_panel(LAYOUT_ROTATE_90, false, LAYOUT_WIRING_PROGRESSIVE, rotated_90);
+    check_panel(LAYOUT_ROTATE_180, false, LAYOUT_WIRING_PROGRESSIVE, rotated_180);
+    check_panel(LAYOUT_ROTATE_270, false, LAYOUT_WIRING_PROGRESSIVE, rotated_270);
+    check_panel(LAYOUT_ROTATE_90, false, LAYOUT_WIRING_SERPENTINE, serpentine_90);
+    check_panel(LAYOUT_ROTATE_90, true, LAYOUT_WIRING_PROGRESSIVE, flipped_90);
+
+    // chain of two serpentine panels, the second one upside down, byte offsets
+    static const layout_panel_t chain[] = {
+        { .wiring = LAYOUT_WIRING_SERPENTINE, .position = 0 },
+        { .rotation = LAYOUT_ROTATE_180, .wiring = LAYOUT_WIRING_SERPENTINE, .position = 1 },
+    };
+    const layout_t layout = { .panel_width = W, .panel_height = H, .cols = 1, .rows = 2, .panels = chain };
+    const size_t offsets[1] = { 100 };
+    uint32_t map[W * H * 2];
+    TEST_OK(layout_compile(&layout, offsets, 3, map));
+    static const uint32_t expected[] = { 0, 1, 2, 5, 4, 3, 9, 10, 11, 8, 7, 6 };
+    for (size_t i = 0; i < W * H * 2; i++)
+        TEST_ASSERT(map[i] == 100 + expected[i] * 3);
+
+    size_t lengths[2];
+    TEST_OK(layout_get_lengths(&layout, 1, lengths));
+    TEST_ASSERT(lengths[0] == 2 * W * H);
+
+    // unknown lane and duplicate chain position
+    TEST_ASSERT(layout_check(&layout, 0) != ESP_OK);
+    layout_panel_t bad[2];
+    memcpy(bad, chain, sizeof(bad));
+    bad[1].position = 0;
+    const layout_t dup = { .panel_width = W, .panel_height = H, .cols = 1, .rows = 2, .panels = bad };
+    TEST_ASSERT(layout_check(&dup, 1) != ESP_OK);
+
+    return 0;
+}
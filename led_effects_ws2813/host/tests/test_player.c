@@ -0,0 +1,129 @@
+/**
+ * @file test_player.c
+ *
+ * Crossfade is finished by a command taken by the render side, the
+ * outgoing effect is never drawn and commands sent before are executed
+ * when player_finish_crossfade() returns
+ */
+#include <pthread.h>
+#include <sched.h>
+
+#include "player/player.h"
+#include "test.h"
+
+#define WIDTH  4
+#define HEIGHT 4
+
+static player_t player;
+static bool stop;
+static uint32_t drawn_a, drawn_b; // written by render side
+static uint32_t handled;
+
+static esp_err_t draw_a(framebuffer_t *fb)
+{
+    __atomic_fetch_add(&drawn_a, 1, __ATOMIC_RELAXED);
+    return ESP_OK;
+}
+
+static esp_err_t draw_b(framebuffer_t *fb)
+{
+    __atomic_fetch_add(&drawn_b, 1, __ATOMIC_RELAXED);
+    return ESP_OK;
+}
+
+static esp_err_t handler(const command_t *cmd, void *ctx)
+{
+    __atomic_store_n(&handled, cmd->value, __ATOMIC_RELAXED);
+    return ESP_OK;
+}
+
+static esp_err_t null_render(framebuffer_t *fb, void *arg)
+{
+    return ESP_OK;
+}
+
+// render side, frames as fast as they come instead of at deadlines
+static void *renderer(void *arg)
+{
+    int64_t deadline;
+    while (!__atomic_load_n(&stop, __ATOMIC_RELAXED))
+    {
+        TEST_OK(player_frame(&player, &deadline));
+        sched_yield();
+    }
+
+    return NULL;
+}
+
+static uint32_t frames(const uint32_t *drawn)
+{
+    return __atomic_load_n(drawn, __ATOMIC_RELAXED);
+}
+
+static void wait_frames(const uint32_t *drawn, uint32_t count)
+{
+    uint32_t start = frames(drawn);
+    while (frames(drawn) - start < count)
+        sched_yield();
+}
+
+int main(void)
+{
+    framebuffer_t a, b, mix;
+    TEST_OK(fb_init(&a, WIDTH, HEIGHT, null_render));
+    TEST_OK(fb_init(&b, WIDTH, HEIGHT, null_render));
+    TEST_OK(fb_init(&mix, WIDTH, HEIGHT, null_render));
+
+    TEST_OK(player_init_scheduled(&player, &a, 10, 60));
+    TEST_ASSERT(player_finish_crossfade(&player) == ESP_ERR_INVALID_STATE);
+    TEST_OK(player_play(&player, draw_a, NULL));
+
+    pthread_t thread;
+    TEST_ASSERT(!pthread_create(&thread, NULL, renderer, NULL));
+    wait_frames(&drawn_a, 3);
+
+    // crossfade still queued is started and finished
+    command_t cmd = {
+        .type = PLAYER_CMD_CROSSFADE,
+        .value = 60000,
+        .fb = &b,
+        .mix = &mix,
+        .draw = draw_b,
+    };
+    TEST_OK(player_send(&player, &cmd));
+    TEST_OK(player_finish_crossfade(&player));
+    uint32_t last_a = frames(&drawn_a);
+    wait_frames(&drawn_b, 10);
+    TEST_ASSERT(frames(&drawn_a) == last_a);
+
+    // running crossfade, then nothing to finish
+    cmd.fb = &a;
+    cmd.draw = draw_a;
+    TEST_OK(player_send(&player, &cmd));
+    wait_frames(&drawn_a, 3);
+    TEST_OK(player_finish_crossfade(&player));
+    uint32_t last_b = frames(&drawn_b);
+    wait_frames(&drawn_a, 10);
+    TEST_ASSERT(frames(&drawn_b) == last_b);
+    TEST_OK(player_finish_crossfade(&player));
+    TEST_ASSERT(player.finished == 3);
+
+    // user commands sent before are handled by then too
+    TEST_OK(player_set_command_handler(&player, handler, NULL));
+    command_t user = { .type = PLAYER_CMD_USER, .value = 42 };
+    TEST_OK(player_send(&player, &user));
+    TEST_OK(player_finish_crossfade(&player));
+    TEST_ASSERT(__atomic_load_n(&handled, __ATOMIC_RELAXED) == 42);
+
+    // the command is never taken without render side
+    __atomic_store_n(&stop, true, __ATOMIC_RELAXED);
+    pthread_join(thread, NULL);
+    TEST_ASSERT(player_finish_crossfade(&player) == ESP_ERR_TIMEOUT);
+
+    TEST_OK(player_free(&player));
+    fb_free(&a);
+    fb_free(&b);
+    fb_free(&mix);
+
+    return 0;
+}
@@ -0,0 +1,118 @@
+/**
+ * @file test_tiles.c
+ *
+ * Frames rendered in bands of rows by workers are the same as frames
+ * rendered by a single thread, every row is rendered exactly once,
+ * ranges of rows are split between workers as well and errors don't
+ * leave the framebuffer locked
+ */
+#include <string.h>
+#include <pthread.h>
+
+#include "effects/tiles.h"
+#include "test.h"
+
+#define WIDTH  7
+#define HEIGHT 10 // not a multiple of the number of workers
+#define FRAMES 20
+
+static uint32_t renders[HEIGHT];
+static pthread_t renderer[HEIGHT];
+static size_t fail_row = HEIGHT;
+
+static esp_err_t test_begin(framebuffer_t *fb)
+{
+    return fb_begin(fb);
+}
+
+static esp_err_t test_rows(framebuffer_t *fb, size_t y0, size_t y1)
+{
+    for (size_t y = y0; y < y1; y++)
+    {
+        if (y == fail_row)
+            return ESP_FAIL;
+        for (size_t x = 0; x < fb->width; x++)
+        {
+            uint32_t v = (x * 73 + y * 151 + fb->frame_num * 29) * 2654435761u;
+            fb->data[FB_OFFSET(fb, x, y)] = rgb_from_values(v >> 24, v >> 16, v >> 8);
+        }
+        // rows of different bands are written by different threads
+        renders[y]++;
+        renderer[y] = pthread_self();
+    }
+
+    return ESP_OK;
+}
+
+static const led_effect_t test_effect = {
+    .name = "test",
+    .begin = test_begin,
+    .rows = test_rows,
+};
+
+static esp_err_t null_render(framebuffer_t *fb, void *arg)
+{
+    return ESP_OK;
+}
+
+int main(void)
+{
+    static led_effect_tiles_t tiles;
+    framebuffer_t single, tiled;
+    static rgb_t frames[FRAMES][WIDTH * HEIGHT];
+
+    TEST_OK(fb_init(&single, WIDTH, HEIGHT, null_render));
+    TEST_OK(fb_init(&tiled, WIDTH, HEIGHT, null_render));
+
+    for (size_t f = 0; f < FRAMES; f++)
+    {
+        TEST_OK(led_effect_render(&single, &test_effect));
+        memcpy(frames[f], single.data, sizeof(frames[f]));
+    }
+    for (size_t y = 0; y < HEIGHT; y++)
+        TEST_ASSERT(renders[y] == FRAMES && pthread_equal(renderer[y], pthread_self()));
+
+    TEST_OK(led_effect_tiles_init(&tiles, 3));
+    led_effect_set_tiles(&tiles);
+    memset(renders, 0, sizeof(renders));
+    for (size_t f = 0; f < FRAMES; f++)
+    {
+        TEST_OK(led_effect_render(&tiled, &test_effect));
+        TEST_ASSERT(!memcmp(frames[f], tiled.data, sizeof(frames[f])));
+    }
+    for (size_t y = 0; y < HEIGHT; y++)
+    {
+        TEST_ASSERT(renders[y] == FRAMES);
+        TEST_ASSERT(!pthread_equal(renderer[y], pthread_self()));
+    }
+    // bands 0..3, 3..6, 6..10
+    TEST_ASSERT(pthread_equal(renderer[0], renderer[2]));
+    TEST_ASSERT(!pthread_equal(renderer[2], renderer[3]));
+    TEST_ASSERT(pthread_equal(renderer[3], renderer[5]));
+    TEST_ASSERT(!pthread_equal(renderer[5], renderer[6]));
+    TEST_ASSERT(pthread_equal(renderer[6], renderer[9]));
+
+    // error of any band is the error of the frame
+    fail_row = 7;
+    TEST_ASSERT(led_effect_render_rows(&tiled, &test_effect) == ESP_FAIL);
+    // and the framebuffer is released after it
+    TEST_ASSERT(led_effect_render(&tiled, &test_effect) == ESP_FAIL);
+    TEST_ASSERT(xSemaphoreTake(tiled.mutex, 0));
+    xSemaphoreGive(tiled.mutex);
+    fail_row = HEIGHT;
+    TEST_OK(led_effect_render_rows(&tiled, &test_effect));
+
+    // a range of rows is split between workers too, rows outside it are untouched
+    memset(renders, 0, sizeof(renders));
+    TEST_OK(led_effect_render_row_range(&tiled, &test_effect, 4, 9));
+    for (size_t y = 0; y < HEIGHT; y++)
+        TEST_ASSERT(renders[y] == (y >= 4 && y < 9));
+    TEST_ASSERT(!pthread_equal(renderer[4], renderer[8]));
+    TEST_ASSERT(led_effect_render_row_range(&tiled, &test_effect, 5, HEIGHT + 1) == ESP_ERR_INVALID_ARG);
+
+    TEST_OK(led_effect_tiles_free(&tiles));
+    fb_free(&single);
+    fb_free(&tiled);
+
+    return 0;
+}
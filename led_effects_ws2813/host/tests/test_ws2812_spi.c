@@ -0,0 +1,37 @@
+/**
+ * @file test_ws2812_spi.c
+ *
+ * WS2812 SPI encoding: every bit is a nibble, 1000 for 0 and 1110 for 1,
+ * MSB first, table words are sent byte by byte
+ */
+#include "output/ws2812_spi.h"
+#include "test.h"
+
+int main(void)
+{
+    TEST_ASSERT(ws2812_spi_encode(0x00) == 0x88888888);
+    TEST_ASSERT(ws2812_spi_encode(0xff) == 0xeeeeeeee);
+    TEST_ASSERT(ws2812_spi_encode(0x80) == 0xe8888888);
+    TEST_ASSERT(ws2812_spi_encode(0x01) == 0x8888888e);
+    TEST_ASSERT(ws2812_spi_encode(0xa5) == 0xe8e88e8e);
+
+    // 3.2 MHz, 4 SPI bits per WS2812 bit: 1.25 us per bit
+    TEST_ASSERT(WS2812_SPI_CLOCK_HZ / 4 == 800000);
+
+    static uint32_t table[256];
+    ws2812_spi_encoding_init(table);
+    for (int i = 0; i < 256; i++)
+    {
+        const uint8_t *bytes = (const uint8_t *)&table[i];
+        uint32_t word = ws2812_spi_encode(i);
+        TEST_ASSERT(bytes[0] == (uint8_t)(word >> 24));
+        TEST_ASSERT(bytes[1] == (uint8_t)(word >> 16));
+        TEST_ASSERT(bytes[2] == (uint8_t)(word >> 8));
+        TEST_ASSERT(bytes[3] == (uint8_t)word);
+    }
+    // first byte on the wire holds the two most significant bits
+    TEST_ASSERT(((const uint8_t *)&table[0xc0])[0] == 0xee);
+    TEST_ASSERT(((const uint8_t *)&table[0x40])[0] == 0x8e);
+
+    return 0;
+}
@@ -0,0 +1,93 @@
+/**
+ * @file test_zones.c
+ *
+ * Outputs of zones number their lanes from `first_lane`, so lanes of
+ * all zones are distinct in the shared frame log
+ */
+#include <string.h>
+
+#include "output/output.h"
+#include "output/backends.h"
+#include "test.h"
+
+#define ZONES      4
+#define ZONE_LANES 1
+#define PANEL_SIZE 4
+
+static int64_t virtual_clock(void)
+{
+    return 0;
+}
+
+int main(void)
+{
+    // same layout and lane split for every zone, like in main.c
+    static const layout_panel_t panel = { .wiring = LAYOUT_WIRING_SERPENTINE };
+    static const layout_t layout = {
+        .panel_width = PANEL_SIZE,
+        .panel_height = PANEL_SIZE,
+        .cols = 1,
+        .rows = 1,
+        .panels = &panel,
+    };
+    static output_t outputs[ZONES];
+    framebuffer_t fbs[ZONES];
+
+    FILE *file = tmpfile();
+    TEST_ASSERT(file);
+    static frame_log_t log;
+    TEST_OK(frame_log_init(&log, file, 0, virtual_clock));
+    output_backend_mock_set_log(&log);
+
+    for (size_t z = 0; z < ZONES; z++)
+    {
+        output_config_t config = {
+            .backend = &output_backend_mock,
+            .layout = &layout,
+            .brightness = 255,
+            .gamma = 1.0f,
+            .white = { .r = 255, .g = 255, .b = 255 },
+            .channel_current = 50,
+            .num_lanes = ZONE_LANES,
+            .first_lane = z * ZONE_LANES,
+        };
+        TEST_OK(output_init(&outputs[z], &config));
+        TEST_ASSERT(outputs[z].lanes[0].num == z);
+        TEST_OK(fb_init(&fbs[z], PANEL_SIZE, PANEL_SIZE, output_render));
+    }
+
+    // zones render in any order, every one with its own color
+    static const size_t order[ZONES] = { 2, 0, 3, 1 };
+    for (size_t i = 0; i < ZONES; i++)
+    {
+        size_t z = order[i];
+        for (size_t p = 0; p < PANEL_SIZE * PANEL_SIZE; p++)
+            fbs[z].data[p] = rgb_from_values(z + 1, 0, 0);
+        TEST_OK(fb_render(&fbs[z], &outputs[z]));
+    }
+    TEST_ASSERT(log.records == ZONES);
+
+    fseek(file, 8, SEEK_SET);
+    for (size_t i = 0; i < ZONES; i++)
+    {
+        uint8_t record[24];
+        TEST_ASSERT(fread(record, sizeof(record), 1, file) == 1);
+        size_t lane = record[8] | record[9] << 8;
+        TEST_ASSERT(lane == order[i]);
+        // checksum of the lane data of that very zone
+        const uint8_t *data = output_backend_mock_data(&outputs[lane].lanes[0]);
+        TEST_ASSERT(data[1] == lane + 1);
+        uint32_t checksum = record[20] | record[21] << 8 | record[22] << 16 | (uint32_t)record[23] << 24;
+        TEST_ASSERT(checksum == frame_log_checksum(data, PANEL_SIZE * PANEL_SIZE * OUTPUT_COLOR_SIZE));
+    }
+
+    output_backend_mock_set_log(NULL);
+    fclose(file);
+    for (size_t z = 0; z < ZONES; z++)
+    {
+        fb_free(&fbs[z]);
+        TEST_OK(output_free(&outputs[z]));
+    }
+
+    return 0;
+}
@@ -1,2 +1,2 @@
 COMPONENT_ADD_INCLUDEDIRS = .
-COMPONENT_SRCDIRS = . effects
+COMPONENT_SRCDIRS = . effects output player
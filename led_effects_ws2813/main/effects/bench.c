@@ -0,0 +1,228 @@
+/**
+ * @file bench.c
+ *
+ * Benchmark and golden checksums of all effects
+ */
+#include <stdio.h>
+#include <esp_log.h>
+#include <esp_timer.h>
+#include <esp_heap_caps.h>
+
+#ifdef ESP_PLATFORM
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#endif
+
+#include "effects/bench.h"
+#include "output/frame_log.h"
+#include "player/blend.h"
+
+#define CHECK(x) do { esp_err_t __; if ((__ = x) != ESP_OK) return __; } while (0)
+#define CHECK_ARG(VAL) do { if (!(VAL)) return ESP_ERR_INVALID_ARG; } while (0)
+
+static const char *TAG = "led_effect_bench";
+
+static int64_t virtual_time = 0;
+
+// virtual clock, every frame is a single step at reference rate
+static int64_t virtual_clock(void)
+{
+    return virtual_time;
+}
+
+static esp_err_t null_render(framebuffer_t *fb, void *arg)
+{
+    return ESP_OK;
+}
+
+// parameters in the middle of their ranges
+static void middle_params(const led_effect_t *effect, uint8_t *params)
+{
+    for (size_t p = 0; p < effect->num_params; p++)
+        params[p] = (effect->params[p].min + effect->params[p].max) / 2;
+}
+
+static uint32_t chain_checksum(uint32_t checksum, const framebuffer_t *fb)
+{
+    return (checksum * 16777619u) ^ frame_log_checksum((const uint8_t *)fb->data, fb->width * fb->height * sizeof(rgb_t));
+}
+
+typedef struct
+{
+    framebuffer_t fb;
+    led_effect_arena_t arena;
+    void *arena_buf;
+} bench_fb_t;
+
+static esp_err_t bench_fb_init(bench_fb_t *b, size_t width, size_t height)
+{
+    size_t arena_size = LED_EFFECT_ARENA_SIZE(width, height);
+    b->arena_buf = heap_caps_aligned_alloc(LED_EFFECT_ALIGN, arena_size, MALLOC_CAP_8BIT);
+    if (!b->arena_buf)
+        return ESP_ERR_NO_MEM;
+    esp_err_t res = fb_init(&b->fb, width, height, null_render);
+    if (res != ESP_OK)
+    {
+        heap_caps_aligned_free(b->arena_buf);
+        return res;
+    }
+    led_effect_arena_init(&b->arena, b->arena_buf, arena_size);
+    led_effect_arena_attach(&b->fb, &b->arena);
+
+    return ESP_OK;
+}
+
+static void bench_fb_free(bench_fb_t *b)
+{
+    led_effect_arena_attach(&b->fb, NULL);
+    fb_free(&b->fb);
+    heap_caps_aligned_free(b->arena_buf);
+}
+
+// from the first frame on, same seed, parameters and time every run
+static esp_err_t restart(bench_fb_t *b, const led_effect_t *effect, const uint8_t *params)
+{
+    virtual_time = 0;
+    led_effect_arena_reset(&b->arena);
+    fb_clear(&b->fb);
+
+    return effect->init(&b->fb, params);
+}
+
+// run initialized effect, return time of all frames in us, chain checksums of frames
+static int64_t run_effect(framebuffer_t *fb, const led_effect_t *effect, size_t frames, uint32_t *checksum)
+{
+    int64_t elapsed = 0;
+    *checksum = 0;
+    for (size_t f = 0; f < frames; f++)
+    {
+        int64_t start = esp_timer_get_time();
+        effect->run(fb);
+        elapsed += esp_timer_get_time() - start;
+        virtual_time += 1000000 / LED_EFFECT_REF_FPS;
+        // not measured
+        *checksum = chain_checksum(*checksum, fb);
+#ifdef ESP_PLATFORM
+        // let idle task feed watchdog, not measured
+        vTaskDelay(1);
+#endif
+    }
+
+    return elapsed;
+}
+
+static void print_result(const char *name, const char *suffix, size_t size, size_t frames, int64_t us, size_t state_bytes)
+{
+    long long ns_per_frame = us * 1000 / (int64_t)frames;
+    printf("BENCH,%s%s,%u,%u,%u,%lld,%lld,%u\n", name, suffix, (unsigned)size, (unsigned)size, (unsigned)frames,
+            ns_per_frame, ns_per_frame / (long long)(size * size), (unsigned)state_bytes);
+}
+
+esp_err_t led_effect_benchmark(const size_t *sizes, size_t num_sizes, size_t frames, led_effect_tiles_t *tiles)
+{
+    size_t mismatches = 0;
+    led_effect_set_time_source(virtual_clock);
+    printf("BENCH,effect,width,height,frames,ns_per_frame,ns_per_pixel,state_bytes\n");
+
+    for (size_t s = 0; s < num_sizes; s++)
+    {
+        size_t size = sizes[s];
+        bench_fb_t b;
+        if (bench_fb_init(&b, size, size) != ESP_OK)
+        {
+            ESP_LOGW(TAG, "Not enough memory to benchmark effects at %ux%u", (unsigned)size, (unsigned)size);
+            continue;
+        }
+
+        for (size_t i = 0; i < led_effects_count; i++)
+        {
+            const led_effect_t *effect = led_effects[i];
+            uint8_t params[LED_EFFECT_MAX_PARAMS];
+            middle_params(effect, params);
+
+            if (restart(&b, effect, params) != ESP_OK)
+            {
+                ESP_LOGW(TAG, "Could not init effect %s at %ux%u", effect->name, (unsigned)size, (unsigned)size);
+                continue;
+            }
+            uint32_t checksum;
+            int64_t us = run_effect(&b.fb, effect, frames, &checksum);
+            size_t state_bytes = b.arena.used;
+            effect->done(&b.fb);
+            print_result(effect->name, "", size, frames, us, state_bytes);
+
+            if (!tiles || !effect->rows)
+                continue;
+
+            // same frames rendered on all workers
+            if (restart(&b, effect, params) != ESP_OK)
+                continue;
+            led_effect_set_tiles(tiles);
+            uint32_t tiled_checksum;
+            us = run_effect(&b.fb, effect, frames, &tiled_checksum);
+            led_effect_set_tiles(NULL);
+            effect->done(&b.fb);
+            print_result(effect->name, " (tiled)", size, frames, us, state_bytes);
+
+            if (tiled_checksum != checksum)
+            {
+                ESP_LOGE(TAG, "Tiled frames of effect %s at %ux%u differ: %08x, expected %08x",
+                        effect->name, (unsigned)size, (unsigned)size, (unsigned)tiled_checksum, (unsigned)checksum);
+                mismatches++;
+            }
+        }
+
+        // crossfade cost on top of both effects, frame blended with itself
+        int64_t start = esp_timer_get_time();
+        for (size_t f = 0; f < frames; f++)
+            blend_rgb(b.fb.data, b.fb.data, b.fb.data, size * size, f);
+        print_result("blend", "", size, frames, esp_timer_get_time() - start, 0);
+
+        bench_fb_free(&b);
+    }
+
+    led_effect_set_time_source(NULL);
+
+    if (mismatches)
+    {
+        ESP_LOGE(TAG, "Tiled frames of %u effect runs differ", (unsigned)mismatches);
+        return ESP_FAIL;
+    }
+
+    return ESP_OK;
+}
+
+esp_err_t led_effect_golden(size_t size, size_t frames)
+{
+    CHECK_ARG(size && frames);
+
+    bench_fb_t b;
+    CHECK(bench_fb_init(&b, size, size));
+    led_effect_set_time_source(virtual_clock);
+    printf("GOLDEN,effect,width,height,frames,checksum\n");
+
+    for (size_t i = 0; i < led_effects_count; i++)
+    {
+        const led_effect_t *effect = led_effects[i];
+        uint8_t params[LED_EFFECT_MAX_PARAMS];
+        middle_params(effect, params);
+
+        led_effect_set_seed(i + 1);
+        if (restart(&b, effect, params) != ESP_OK)
+        {
+            ESP_LOGW(TAG, "Could not init effect %s", effect->name);
+            continue;
+        }
+        uint32_t checksum;
+        run_effect(&b.fb, effect, frames, &checksum);
+        effect->done(&b.fb);
+
+        printf("GOLDEN,%s,%u,%u,%u,%08x\n", effect->name, (unsigned)size, (unsigned)size, (unsigned)frames,
+                (unsigned)checksum);
+    }
+
+    led_effect_set_time_source(NULL);
+    bench_fb_free(&b);
+
+    return ESP_OK;
+}
@@ -0,0 +1,61 @@
+/**
+ * @file bench.h
+ *
+ * @defgroup led_effect_bench led_effect_bench
+ * @{
+ *
+ * Benchmark and golden checksums of all effects
+ *
+ * Both run every effect on a framebuffer without output, with parameters
+ * in the middle of their ranges and with virtual time, every frame is a
+ * single step at reference rate. Results are printed to stdout as CSV
+ * lines prefixed with "BENCH," and "GOLDEN,", see tools/bench.py and
+ * tools/golden.py. The same code runs on the device and on the host.
+ */
+#ifndef __LED_EFFECTS_BENCH_H__
+#define __LED_EFFECTS_BENCH_H__
+
+#include "effects/effect.h"
+#include "effects/tiles.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Benchmark all effects
+ *
+ * Prints time per frame, time per pixel and bytes of effect state of every
+ * effect at every size memory allows. Effects with `rows` are run once more
+ * on workers and printed as "(tiled)", an error is logged if their frames
+ * differ from frames rendered on a single thread.
+ *
+ * @param sizes Matrix sizes, every matrix is square
+ * @param num_sizes Number of sizes
+ * @param frames Frames per effect
+ * @param tiles Workers for tiled runs, NULL to skip them
+ * @return `ESP_OK` on success, `ESP_FAIL` if tiled frames of any effect
+ *         differ
+ */
+esp_err_t led_effect_benchmark(const size_t *sizes, size_t num_sizes, size_t frames, led_effect_tiles_t *tiles);
+
+/**
+ * @brief Print golden checksums of all effects
+ *
+ * Every effect is seeded with its index + 1, checksums of all its frames
+ * are chained into one. Random streams are left seeded, reseed them
+ * afterwards.
+ *
+ * @param size Matrix size, matrix is square
+ * @param frames Frames per effect
+ * @return `ESP_OK` on success
+ */
+esp_err_t led_effect_golden(size_t size, size_t frames);
+
+#ifdef __cplusplus
+}
+#endif
+
+/**@}*/
+
+#endif /* __LED_EFFECTS_BENCH_H__ */
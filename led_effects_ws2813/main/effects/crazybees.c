@@ -24,16 +24,24 @@ typedef struct
 {
     uint8_t num_bees;
     bee_t bees[CRAZYBEES_MAX_BEES];
+    led_effect_clock_t clock;
+    led_effect_params_t pending;
+    led_effect_rng_t rng;
 } params_t;
 
+LED_EFFECT_CHECK_STATE(sizeof(params_t), 0);
+
 esp_err_t led_effect_crazybees_init(framebuffer_t *fb, uint8_t num_bees)
 {
     CHECK_ARG(fb && num_bees && num_bees <= CRAZYBEES_MAX_BEES);
 
-    fb->internal = calloc(1, sizeof(params_t));
+    fb->internal = led_effect_alloc(fb, sizeof(params_t));
     if (!fb->internal)
         return ESP_ERR_NO_MEM;
 
+    // seed random stream
+    led_effect_rng_init(&((params_t *)fb->internal)->rng);
+
     return led_effect_crazybees_set_params(fb, num_bees);
 }
 
@@ -42,7 +50,7 @@ esp_err_t led_effect_crazybees_done(framebuffer_t *fb)
     CHECK_ARG(fb);
 
     if (fb->internal)
-        free(fb->internal);
+        led_effect_free(fb, fb->internal);
 
     return ESP_OK;
 }
@@ -50,14 +58,15 @@ esp_err_t led_effect_crazybees_done(framebuffer_t *fb)
 static void change_flower(framebuffer_t *fb, uint8_t bee)
 {
     params_t *params = (params_t *)fb->internal;
-    params->bees[bee].flower_x = random8_to(fb->width);
-    params->bees[bee].flower_y = random8_to(fb->height);
-    params->bees[bee].hue = random8();
+    params->bees[bee].flower_x = led_effect_random8_to(&params->rng, fb->width);
+    params->bees[bee].flower_y = led_effect_random8_to(&params->rng, fb->height);
+    params->bees[bee].hue = led_effect_random8(&params->rng);
 }
 
-esp_err_t led_effect_crazybees_set_params(framebuffer_t *fb, uint8_t num_bees)
+// applies published parameters, render side only
+static esp_err_t apply_params(framebuffer_t *fb, const uint8_t *p)
 {
-    CHECK_ARG(fb && fb->internal && num_bees && num_bees <= CRAZYBEES_MAX_BEES);
+    uint8_t num_bees = p[0];
 
     params_t *params = (params_t *)fb->internal;
     params->num_bees = num_bees;
@@ -65,8 +74,8 @@ esp_err_t led_effect_crazybees_set_params(framebuffer_t *fb, uint8_t num_bees)
     for (uint8_t i = 0; i < num_bees; i++)
     {
         // set bee
-        params->bees[i].x = random8_to(fb->width);
-        params->bees[i].y = random8_to(fb->height);
+        params->bees[i].x = led_effect_random8_to(&params->rng, fb->width);
+        params->bees[i].y = led_effect_random8_to(&params->rng, fb->height);
         // set flower
         change_flower(fb, i);
     }
@@ -74,12 +83,19 @@ esp_err_t led_effect_crazybees_set_params(framebuffer_t *fb, uint8_t num_bees)
     return ESP_OK;
 }
 
-esp_err_t led_effect_crazybees_run(framebuffer_t *fb)
+esp_err_t led_effect_crazybees_set_params(framebuffer_t *fb, uint8_t num_bees)
 {
-    CHECK(fb_begin(fb));
+    CHECK_ARG(fb && fb->internal && num_bees && num_bees <= CRAZYBEES_MAX_BEES);
 
-    params_t *params = (params_t *)fb->internal;
+    uint8_t p[LED_EFFECT_MAX_PARAMS] = { num_bees };
+    led_effect_params_publish(&((params_t *)fb->internal)->pending, p);
+
+    return ESP_OK;
+}
 
+// single step of simulation at reference frame rate
+static void step(framebuffer_t *fb, params_t *params)
+{
     static rgb_t white = { .r = 255, .g = 255, .b = 255 };
 
     fb_fade(fb, 8);
@@ -106,6 +122,44 @@ esp_err_t led_effect_crazybees_run(framebuffer_t *fb)
         fb_set_pixel_hsv(fb, params->bees[i].flower_x, params->bees[i].flower_y + 1, c);
     }
     fb_blur2d(fb, 16);
+}
+
+esp_err_t led_effect_crazybees_run(framebuffer_t *fb)
+{
+    CHECK_ARG(fb && fb->internal);
+
+    params_t *params = (params_t *)fb->internal;
+    CHECK(led_effect_begin(fb, &params->clock));
+
+    // parameters published since the previous frame
+    uint8_t p[LED_EFFECT_MAX_PARAMS];
+    if (led_effect_params_take(&params->pending, p))
+        CHECK(apply_params(fb, p));
+
+    for (uint32_t i = 0; i < params->clock.steps; i++)
+        step(fb, params);
 
     return fb_end(fb);
 }
+
+static esp_err_t crazybees_update_params(framebuffer_t *fb, const uint8_t *p)
+{
+    return led_effect_crazybees_set_params(fb, p[0]);
+}
+
+static esp_err_t crazybees_init_params(framebuffer_t *fb, const uint8_t *p)
+{
+    return led_effect_crazybees_init(fb, p[0]);
+}
+
+const led_effect_t led_effect_crazybees = {
+    .name = "Crazy bees",
+    .init = crazybees_init_params,
+    .run = led_effect_crazybees_run,
+    .done = led_effect_crazybees_done,
+    .set_params = crazybees_update_params,
+    .num_params = 1,
+    .params = { { 2, 4 } },
+    .state_size = sizeof(params_t),
+    .cycles_per_pixel = 30,
+};
@@ -13,12 +13,16 @@
 
 #include <framebuffer.h>
 
+#include "effects/effect.h"
+
 #ifdef __cplusplus
 extern "C" {
 #endif
 
 #define CRAZYBEES_MAX_BEES 10
 
+extern const led_effect_t led_effect_crazybees;
+
 esp_err_t led_effect_crazybees_init(framebuffer_t *fb, uint8_t num_bees);
 
 esp_err_t led_effect_crazybees_done(framebuffer_t *fb);
@@ -28,14 +28,18 @@ typedef struct
     uint8_t size;
     bool border;
     uint32_t offset;
+    led_effect_clock_t clock;
+    led_effect_params_t pending;
 } params_t;
 
+LED_EFFECT_CHECK_STATE(sizeof(params_t), 0);
+
 esp_err_t led_effect_dna_init(framebuffer_t *fb, uint8_t speed, uint8_t size, bool border)
 {
     CHECK_ARG(fb);
 
     // allocate internal storage
-    fb->internal = calloc(1, sizeof(params_t));
+    fb->internal = led_effect_alloc(fb, sizeof(params_t));
     if (!fb->internal)
         return ESP_ERR_NO_MEM;
 
@@ -48,14 +52,17 @@ esp_err_t led_effect_dna_done(framebuffer_t *fb)
 
     // free internal storage
     if (fb->internal)
-        free(fb->internal);
+        led_effect_free(fb, fb->internal);
 
     return ESP_OK;
 }
 
-esp_err_t led_effect_dna_set_params(framebuffer_t *fb, uint8_t speed, uint8_t size, bool border)
+// applies published parameters, render side only
+static esp_err_t apply_params(framebuffer_t *fb, const uint8_t *p)
 {
-    CHECK_ARG(fb && fb->internal);
+    uint8_t speed = p[0];
+    uint8_t size = p[1];
+    bool border = p[2];
 
     params_t *params = (params_t *)fb->internal;
     params->speed = speed;
@@ -65,6 +72,16 @@ esp_err_t led_effect_dna_set_params(framebuffer_t *fb, uint8_t speed, uint8_t si
     return ESP_OK;
 }
 
+esp_err_t led_effect_dna_set_params(framebuffer_t *fb, uint8_t speed, uint8_t size, bool border)
+{
+    CHECK_ARG(fb && fb->internal);
+
+    uint8_t p[LED_EFFECT_MAX_PARAMS] = { speed, size, border };
+    led_effect_params_publish(&((params_t *)fb->internal)->pending, p);
+
+    return ESP_OK;
+}
+
 static const rgb_t dark_slate_gray = { .r = 0x2f, .g = 0x4f, .b = 0x4f };
 static const rgb_t white = { .r = 0xff, .g = 0xff, .b = 0xff };
 
@@ -93,18 +110,25 @@ void horizontal_line(framebuffer_t *fb, uint8_t x1, uint8_t x2, uint8_t y, rgb_t
 
 esp_err_t led_effect_dna_run(framebuffer_t *fb)
 {
-    CHECK(fb_begin(fb));
+    CHECK_ARG(fb && fb->internal);
 
     params_t *params = (params_t *)fb->internal;
+    CHECK(led_effect_begin(fb, &params->clock));
+
+    // parameters published since the previous frame
+    uint8_t p[LED_EFFECT_MAX_PARAMS];
+    if (led_effect_params_take(&params->pending, p))
+        CHECK(apply_params(fb, p));
 
-    params->offset += params->speed / 10;
+    params->offset += params->speed / 10 * params->clock.steps;
 
-    fb_fade(fb, 130);
+    for (uint32_t i = 0; i < params->clock.steps; i++)
+        fb_fade(fb, 130);
 
-    for (uint8_t i = 0; i < fb->height; i++)
+    for (size_t i = 0; i < fb->height; i++)
     {
-        uint16_t x1 = beatsin8(params->speed, 0, fb->width - 1, 0, i * params->size) + beatsin8(params->speed - 7, 0, fb->width - 1, 0, i * params->size + 128);
-        uint16_t x2 = beatsin8(params->speed, 0, fb->width - 1, 0, 128 + i * params->size) + beatsin8(params->speed - 7, 0, fb->width - 1, 0, 128 + 64 + i * params->size);
+        uint16_t x1 = led_effect_beatsin8(&params->clock, params->speed, 0, fb->width - 1, i * params->size) + led_effect_beatsin8(&params->clock, params->speed - 7, 0, fb->width - 1, i * params->size + 128);
+        uint16_t x2 = led_effect_beatsin8(&params->clock, params->speed, 0, fb->width - 1, 128 + i * params->size) + led_effect_beatsin8(&params->clock, params->speed - 7, 0, fb->width - 1, 128 + 64 + i * params->size);
 
         rgb_t color = hsv2rgb_rainbow(hsv_from_values(i * 128 / (fb->height - 1) + params->offset, 255, 255));
 
@@ -114,3 +138,25 @@ esp_err_t led_effect_dna_run(framebuffer_t *fb)
 
     return fb_end(fb);
 }
+
+static esp_err_t dna_update_params(framebuffer_t *fb, const uint8_t *p)
+{
+    return led_effect_dna_set_params(fb, p[0], p[1], p[2]);
+}
+
+static esp_err_t dna_init_params(framebuffer_t *fb, const uint8_t *p)
+{
+    return led_effect_dna_init(fb, p[0], p[1], p[2]);
+}
+
+const led_effect_t led_effect_dna = {
+    .name = "DNA",
+    .init = dna_init_params,
+    .run = led_effect_dna_run,
+    .done = led_effect_dna_done,
+    .set_params = dna_update_params,
+    .num_params = 3,
+    .params = { { 10, 99 }, { 1, 9 }, { 0, 1 } },
+    .state_size = sizeof(params_t),
+    .cycles_per_pixel = 60,
+};
@@ -20,10 +20,14 @@
 
 #include <framebuffer.h>
 
+#include "effects/effect.h"
+
 #ifdef __cplusplus
 extern "C" {
 #endif
 
+extern const led_effect_t led_effect_dna;
+
 esp_err_t led_effect_dna_init(framebuffer_t *fb, uint8_t speed, uint8_t size, bool border);
 
 esp_err_t led_effect_dna_done(framebuffer_t *fb);
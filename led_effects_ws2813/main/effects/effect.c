@@ -0,0 +1,320 @@
+/**
+ * @file effect.c
+ *
+ * Effect descriptors and registry
+ */
+#include <lib8tion.h>
+#include <esp_timer.h>
+#include <esp_system.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "effects/effect.h"
+#include "effects/noise.h"
+#include "effects/plasma_waves.h"
+#include "effects/rainbow.h"
+#include "effects/waterfall.h"
+#include "effects/dna.h"
+#include "effects/rays.h"
+#include "effects/crazybees.h"
+#include "effects/sparkles.h"
+#include "effects/matrix.h"
+#include "effects/rain.h"
+#include "effects/fire.h"
+#include "player/blend.h"
+
+const led_effect_t *const led_effects[] = {
+    &led_effect_dna,
+    &led_effect_noise,
+    &led_effect_waterfall_fire,
+    &led_effect_waterfall,
+    &led_effect_plasma_waves,
+    &led_effect_rainbow,
+    &led_effect_rays,
+    &led_effect_crazybees,
+    &led_effect_sparkles,
+    &led_effect_matrix,
+    &led_effect_rain,
+    &led_effect_fire,
+};
+
+const size_t led_effects_count = sizeof(led_effects) / sizeof(led_effects[0]);
+
+// render side gives up taking parameters after that many torn copies
+#define PARAMS_ATTEMPTS 3
+
+#define REF_FRAME_US (1000000 / LED_EFFECT_REF_FPS)
+
+#define CHECK(x) do { esp_err_t __; if ((__ = x) != ESP_OK) return __; } while (0)
+#define CHECK_ARG(VAL) do { if (!(VAL)) return ESP_ERR_INVALID_ARG; } while (0)
+
+static int64_t (*time_source)(void) = esp_timer_get_time;
+
+static uint32_t rng_seed = 0;
+
+// arenas attached to framebuffers, linked through the arenas themselves
+static led_effect_arena_t *attached = NULL;
+
+static led_effect_arena_t *find_arena(const framebuffer_t *fb)
+{
+    for (led_effect_arena_t *arena = attached; arena; arena = arena->next)
+        if (arena->fb == fb)
+            return arena;
+
+    return NULL;
+}
+
+static void detach(const framebuffer_t *fb, const led_effect_arena_t *arena)
+{
+    for (led_effect_arena_t **link = &attached; *link;)
+    {
+        led_effect_arena_t *a = *link;
+        if (a->fb == fb || a == arena)
+        {
+            *link = a->next;
+            a->fb = NULL;
+            a->next = NULL;
+        }
+        else
+            link = &a->next;
+    }
+}
+
+static bool in_arena(const led_effect_arena_t *arena, const void *ptr)
+{
+    return (const uint8_t *)ptr >= arena->base && (const uint8_t *)ptr < arena->base + arena->size;
+}
+
+void led_effect_params_publish(led_effect_params_t *pending, const uint8_t *params)
+{
+    uint32_t seq = __atomic_load_n(&pending->seq, __ATOMIC_RELAXED) & ~1u;
+
+    // buffer not being published, readers never copy it
+    __atomic_store_n(&pending->seq, seq + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    memcpy(pending->buf[(seq / 2 + 1) % 2], params, LED_EFFECT_MAX_PARAMS);
+    __atomic_store_n(&pending->seq, seq + 2, __ATOMIC_RELEASE);
+}
+
+bool led_effect_params_take(led_effect_params_t *pending, uint8_t *params)
+{
+    for (size_t attempt = 0; attempt < PARAMS_ATTEMPTS; attempt++)
+    {
+        // last published update, even if the next one is being written
+        uint32_t seq = __atomic_load_n(&pending->seq, __ATOMIC_ACQUIRE) & ~1u;
+        if (seq == pending->taken)
+            return false;
+
+        memcpy(params, pending->buf[(seq / 2) % 2], LED_EFFECT_MAX_PARAMS);
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+
+        // copied buffer is overwritten only by the update after the next one
+        if (__atomic_load_n(&pending->seq, __ATOMIC_RELAXED) - seq < 3)
+        {
+            pending->taken = seq;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void led_effect_set_time_source(int64_t (*source)(void))
+{
+    time_source = source ? source : esp_timer_get_time;
+}
+
+int64_t led_effect_time(void)
+{
+    return time_source();
+}
+
+esp_err_t led_effect_begin(framebuffer_t *fb, led_effect_clock_t *clock)
+{
+    CHECK_ARG(clock);
+    CHECK(fb_begin(fb));
+
+    int64_t t = time_source();
+    if (!clock->started)
+    {
+        // first frame makes a single step
+        clock->started = true;
+        clock->start = t;
+        clock->now = 0;
+        clock->dt = 0;
+        clock->frames = 0;
+        clock->prev = 0;
+        clock->steps = 1;
+        clock->residue = 0;
+    }
+    else
+    {
+        clock->dt = t - clock->start - clock->now;
+        clock->now = t - clock->start;
+        clock->prev = clock->frames;
+        clock->frames = clock->now * LED_EFFECT_REF_FPS / 1000000;
+
+        // rounded, so jitter of frame times doesn't make 0 or 2 steps at reference rate
+        clock->residue += clock->dt;
+        int32_t steps = (clock->residue + REF_FRAME_US / 2) / REF_FRAME_US;
+        if (steps < 0)
+            steps = 0;
+        clock->residue -= steps * REF_FRAME_US;
+        if (steps > LED_EFFECT_MAX_STEPS)
+        {
+            steps = LED_EFFECT_MAX_STEPS;
+            clock->residue = 0;
+        }
+        clock->steps = steps;
+    }
+    clock->ms = clock->now / 1000;
+
+    return ESP_OK;
+}
+
+bool led_effect_every(const led_effect_clock_t *clock, uint32_t period)
+{
+    return clock->frames / period != clock->prev / period || !clock->now;
+}
+
+uint8_t led_effect_beatsin8(const led_effect_clock_t *clock, uint8_t bpm, uint8_t low, uint8_t high, uint8_t phase)
+{
+    // same as beat8(): bpm in Q8.8, 280 / 65536 is 1 / 60000 ms scaled to 16 bits
+    uint8_t beat = ((clock->ms * ((uint32_t)bpm << 8) * 280) >> 16) >> 8;
+
+    return low + scale8(sin8(beat + phase), high - low);
+}
+
+esp_err_t led_effect_arena_init(led_effect_arena_t *arena, void *buf, size_t size)
+{
+    CHECK_ARG(arena && buf && size && !((uintptr_t)buf % LED_EFFECT_ALIGN));
+
+    arena->base = (uint8_t *)buf;
+    arena->size = size;
+    arena->used = 0;
+    arena->fb = NULL;
+    arena->next = NULL;
+
+    return ESP_OK;
+}
+
+void led_effect_arena_reset(led_effect_arena_t *arena)
+{
+    if (arena)
+        arena->used = 0;
+}
+
+esp_err_t led_effect_arena_attach(framebuffer_t *fb, led_effect_arena_t *arena)
+{
+    CHECK_ARG(fb);
+
+    // previous arena of the framebuffer and previous framebuffer of the arena
+    detach(fb, arena);
+    if (!arena)
+        return ESP_OK;
+
+    arena->fb = fb;
+    arena->next = attached;
+    attached = arena;
+
+    return ESP_OK;
+}
+
+void *led_effect_alloc(framebuffer_t *fb, size_t size)
+{
+    led_effect_arena_t *arena = find_arena(fb);
+    if (!arena)
+        return calloc(1, size);
+
+    size_t offset = (arena->used + LED_EFFECT_ALIGN - 1) & ~(size_t)(LED_EFFECT_ALIGN - 1);
+    if (offset + size > arena->size)
+        return NULL;
+    arena->used = offset + size;
+
+    void *ptr = arena->base + offset;
+    memset(ptr, 0, size);
+
+    return ptr;
+}
+
+void led_effect_free(framebuffer_t *fb, void *ptr)
+{
+    if (!ptr)
+        return;
+
+    led_effect_arena_t *arena = find_arena(fb);
+    if (arena && in_arena(arena, ptr))
+        return;
+
+    free(ptr);
+}
+
+size_t led_effect_state_size(const led_effect_t *effect, size_t width, size_t height)
+{
+    if (!effect)
+        return 0;
+
+    return effect->state_size + effect->state_per_pixel * width * height;
+}
+
+bool led_effect_fits(const led_effect_t *effect, size_t width, size_t height, uint32_t fps, uint32_t cpu_hz)
+{
+    if (!effect)
+        return false;
+
+    return led_effect_frame_cycles(effect, width, height) * fps <= cpu_hz;
+}
+
+uint64_t led_effect_frame_cycles(const led_effect_t *effect, size_t width, size_t height)
+{
+#ifdef CONFIG_EXAMPLE_EFFECT_KEYFRAMES
+    if (effect->keyframe_interval > 1)
+    {
+        // rows of the next keyframe are rounded up, see keyframes.c
+        size_t rows = (height + effect->keyframe_interval - 1) / effect->keyframe_interval;
+        return (uint64_t)effect->cycles_per_pixel * width * rows + (uint64_t)BLEND_CYCLES_PER_PIXEL * width * height;
+    }
+#endif
+
+    return (uint64_t)effect->cycles_per_pixel * width * height;
+}
+
+void led_effect_random_params(const led_effect_t *effect, led_effect_rng_t *rng, uint8_t *params)
+{
+    for (size_t i = 0; i < effect->num_params; i++)
+    {
+        uint8_t range = effect->params[i].max - effect->params[i].min;
+        params[i] = range == 255
+                ? led_effect_random8(rng)
+                : effect->params[i].min + led_effect_random8_to(rng, range + 1);
+    }
+}
+
+void led_effect_set_seed(uint32_t seed)
+{
+    rng_seed = seed;
+}
+
+void led_effect_rng_init(led_effect_rng_t *rng)
+{
+    uint32_t seed = rng_seed ? rng_seed : esp_random();
+    // xorshift gets stuck at 0
+    rng->state = seed ? seed : 0x9e3779b9;
+    rng->bits = 0;
+    rng->avail = 0;
+}
+
+void led_effect_random_fill(led_effect_rng_t *rng, uint8_t *buf, size_t len, uint8_t lim)
+{
+    size_t i = 0;
+    for (; i + 4 <= len; i += 4)
+    {
+        uint32_t r = lim ? led_effect_random8x4_to(rng, lim) : led_effect_random32(rng);
+        buf[i] = r;
+        buf[i + 1] = r >> 8;
+        buf[i + 2] = r >> 16;
+        buf[i + 3] = r >> 24;
+    }
+    for (; i < len; i++)
+        buf[i] = lim ? led_effect_random8_to(rng, lim) : led_effect_random8(rng);
+}
@@ -0,0 +1,465 @@
+/**
+ * @file effect.h
+ *
+ * @defgroup led_effect led_effect
+ * @{
+ *
+ * Effect descriptors and registry
+ *
+ * Every effect exports a descriptor with its entry points, ranges of its
+ * parameters, memory it needs and estimated CPU cost, so effects can be
+ * selected, sized and checked against FPS target without knowing their
+ * parameters. Adding an effect takes its descriptor and a single entry
+ * in the registry.
+ *
+ * Effects allocate their state with led_effect_alloc(). If an arena is
+ * attached to the framebuffer, state is taken from it by a bump allocator
+ * and released all at once by led_effect_arena_reset() on effect switch,
+ * so switching effects doesn't touch heap.
+ *
+ * Effects don't read time themselves: every effect keeps a clock in its
+ * state and starts every frame with led_effect_begin(), which captures time
+ * once per frame. Animation is driven by time since the first frame, and
+ * effects simulated step by step (falling drops, moving bees) make
+ * as many steps as reference frames at LED_EFFECT_REF_FPS have elapsed,
+ * so effects look the same at any frame rate.
+ *
+ * Effects don't use global random8()/random16() state either: every
+ * effect has its own random stream seeded on init, see
+ * led_effect_set_seed(). With a fixed seed and a virtual time source
+ * effects render exactly the same frames on every run.
+ *
+ * Parameters of a running effect are not written into its state by the
+ * caller: `*_set_params()` functions publish them into a double-buffered
+ * block in effect state, effect takes them at the start of its next frame.
+ * Parameters can be changed from any task then, without locks and without
+ * a frame rendered with half of them updated.
+ */
+#ifndef __LED_EFFECTS_EFFECT_H__
+#define __LED_EFFECTS_EFFECT_H__
+
+#include <sdkconfig.h>
+#include <framebuffer.h>
+#include <lib8tion.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define LED_EFFECT_MAX_PARAMS 4
+
+#define LED_EFFECT_STATE_FIXED_MAX     512 ///< Max fixed part of effect state, bytes
+#ifdef CONFIG_EXAMPLE_EFFECT_KEYFRAMES
+#define LED_EFFECT_STATE_PER_PIXEL_MAX 9   ///< Max effect state per pixel, bytes, three keyframes
+#else
+#define LED_EFFECT_STATE_PER_PIXEL_MAX 1   ///< Max effect state per pixel, bytes
+#endif
+#define LED_EFFECT_MAX_ALLOCS          4   ///< Max number of allocations of a single effect
+#define LED_EFFECT_ALIGN               8   ///< Alignment of allocations
+
+/**
+ * Arena size fitting the state of any effect at `width` x `height`
+ */
+#define LED_EFFECT_ARENA_SIZE(width, height) \
+    (LED_EFFECT_STATE_FIXED_MAX + LED_EFFECT_STATE_PER_PIXEL_MAX * (width) * (height) \
+     + LED_EFFECT_MAX_ALLOCS * LED_EFFECT_ALIGN)
+
+#define LED_EFFECT_REF_FPS   60 ///< Frame rate effects speeds are defined for
+#define LED_EFFECT_MAX_STEPS 4  ///< Max simulation steps per frame, slower frames lose time
+
+/**
+ * Check effect state limits at build time, use it in effect source
+ */
+#define LED_EFFECT_CHECK_STATE(fixed, per_pixel) \
+    _Static_assert((fixed) <= LED_EFFECT_STATE_FIXED_MAX && (per_pixel) <= LED_EFFECT_STATE_PER_PIXEL_MAX, \
+            "effect state exceeds LED_EFFECT_STATE_*_MAX")
+
+/**
+ * Effect state arena
+ */
+typedef struct led_effect_arena_s
+{
+    uint8_t *base;                   ///< Arena memory
+    size_t size;                     ///< Arena size, bytes
+    size_t used;                     ///< Allocated bytes
+    const framebuffer_t *fb;         ///< Framebuffer the arena is attached to, NULL if none
+    struct led_effect_arena_s *next; ///< Next attached arena
+} led_effect_arena_t;
+
+/**
+ * Range of effect parameter, inclusive
+ */
+typedef struct
+{
+    uint8_t min;
+    uint8_t max;
+} led_effect_param_t;
+
+/**
+ * Per-frame time of effect
+ *
+ * Positions moving at a speed taken from parameters accumulate
+ * `speed * steps`, so a new speed doesn't make them jump.
+ */
+typedef struct
+{
+    bool started;     ///< First frame has been rendered
+    int64_t start;    ///< Time of the first frame, us
+    int64_t now;      ///< Time of the current frame since the first one, us
+    uint32_t ms;      ///< Same as `now`, ms
+    uint32_t dt;      ///< Time since the previous frame, us
+    uint32_t frames;  ///< Reference frames since the first frame
+    uint32_t prev;    ///< Reference frames at the previous frame
+    uint32_t steps;   ///< Reference frames since the previous frame, rounded
+    int32_t residue;  ///< Rounding residue of `steps`, us
+} led_effect_clock_t;
+
+/**
+ * Random stream of effect
+ *
+ * xorshift32 generator, every step gives 32 random bits which are handed
+ * out a byte at a time, so random8() costs a shift most of the time.
+ */
+typedef struct
+{
+    uint32_t state;  ///< Generator state, never 0
+    uint32_t bits;   ///< Buffered random bytes
+    uint8_t avail;   ///< Number of buffered bytes
+} led_effect_rng_t;
+
+/**
+ * Parameters published to a running effect
+ *
+ * Writer fills the buffer not being published and publishes it by bumping
+ * the sequence counter. Render side copies the published buffer and checks
+ * the counter again; the buffer is only overwritten by the update after
+ * the next one, so neither side waits. Updates published between two frames
+ * are merged, the last one wins. Single writer at a time.
+ */
+typedef struct
+{
+    uint32_t seq;                          ///< Published updates * 2, odd while writing
+    uint32_t taken;                        ///< Sequence counter of the last taken update
+    uint8_t buf[2][LED_EFFECT_MAX_PARAMS]; ///< Parameters, `seq / 2 % 2` is published
+} led_effect_params_t;
+
+/**
+ * Effect descriptor
+ */
+typedef struct
+{
+    const char *name;                                  ///< Effect name
+    /**
+     * Allocate effect state and set parameters, `params` are in the
+     * order of effect init function arguments
+     */
+    esp_err_t (*init)(framebuffer_t *fb, const uint8_t *params);
+    esp_err_t (*run)(framebuffer_t *fb);               ///< Render frame
+    esp_err_t (*done)(framebuffer_t *fb);              ///< Free effect state
+    /**
+     * Publish new parameters to running effect, same order as `init`,
+     * applied on its next frame. Safe to call from any task.
+     */
+    esp_err_t (*set_params)(framebuffer_t *fb, const uint8_t *params);
+    /**
+     * Optional, start frame: capture time and take parameters. Together
+     * with `rows` it splits `run` of effects computing every pixel on its
+     * own, so a frame can be rendered on several cores, see
+     * led_effect_render().
+     */
+    esp_err_t (*begin)(framebuffer_t *fb);
+    /**
+     * Optional, render rows `y0` .. `y1 - 1` of frame started by `begin`.
+     * Called concurrently for disjoint ranges of rows.
+     */
+    esp_err_t (*rows)(framebuffer_t *fb, size_t y0, size_t y1);
+    /**
+     * Optional, frames per computed keyframe of effects moving slowly and
+     * smoothly, frames in between are interpolated, see keyframes.h.
+     * 0 or 1 to compute every frame.
+     */
+    uint8_t keyframe_interval;
+    size_t num_params;                                 ///< Number of parameters
+    led_effect_param_t params[LED_EFFECT_MAX_PARAMS];  ///< Ranges of parameters
+    size_t state_size;                                 ///< Bytes of state, fixed part
+    size_t state_per_pixel;                            ///< Bytes of state per pixel
+    uint32_t cycles_per_pixel;                         ///< Estimated CPU cycles per pixel per frame
+} led_effect_t;
+
+/**
+ * Registered effects, in the order they are played
+ */
+extern const led_effect_t *const led_effects[];
+
+/**
+ * Number of registered effects
+ */
+extern const size_t led_effects_count;
+
+/**
+ * @brief Get memory needed by effect state
+ *
+ * @param effect Effect descriptor
+ * @param width Framebuffer width
+ * @param height Framebuffer height
+ * @return Number of bytes
+ */
+size_t led_effect_state_size(const led_effect_t *effect, size_t width, size_t height);
+
+/**
+ * @brief Check if effect can render frames in time
+ *
+ * @param effect Effect descriptor
+ * @param width Framebuffer width
+ * @param height Framebuffer height
+ * @param fps Target FPS
+ * @param cpu_hz CPU cycles per second available for rendering
+ * @return true if `fps` frames at the estimated cost of the most expensive one fit into `cpu_hz`
+ */
+bool led_effect_fits(const led_effect_t *effect, size_t width, size_t height, uint32_t fps, uint32_t cpu_hz);
+
+/**
+ * @brief Get estimated CPU cycles of the most expensive frame
+ *
+ * Effects with keyframes compute a share of rows of the next keyframe in
+ * every frame and blend the frame from the two last keyframes.
+ *
+ * @param effect Effect descriptor
+ * @param width Framebuffer width
+ * @param height Framebuffer height
+ * @return CPU cycles per frame
+ */
+uint64_t led_effect_frame_cycles(const led_effect_t *effect, size_t width, size_t height);
+
+/**
+ * @brief Pick random parameters within their ranges
+ *
+ * @param effect Effect descriptor
+ * @param rng Random stream
+ * @param[out] params `LED_EFFECT_MAX_PARAMS` parameters
+ */
+void led_effect_random_params(const led_effect_t *effect, led_effect_rng_t *rng, uint8_t *params);
+
+/**
+ * @brief Set seed of random streams initialized after this call
+ *
+ * @param seed Seed, 0 for a random seed for every stream
+ */
+void led_effect_set_seed(uint32_t seed);
+
+/**
+ * @brief Seed random stream
+ *
+ * @param rng Random stream
+ */
+void led_effect_rng_init(led_effect_rng_t *rng);
+
+/**
+ * 32 random bits, single generator step
+ */
+static inline uint32_t led_effect_random32(led_effect_rng_t *rng)
+{
+    uint32_t x = rng->state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    rng->state = x;
+    return x;
+}
+
+static inline uint8_t led_effect_random8(led_effect_rng_t *rng)
+{
+    if (!rng->avail)
+    {
+        rng->bits = led_effect_random32(rng);
+        rng->avail = 4;
+    }
+    uint8_t r = rng->bits;
+    rng->bits >>= 8;
+    rng->avail--;
+    return r;
+}
+
+static inline uint16_t led_effect_random16(led_effect_rng_t *rng)
+{
+    return led_effect_random32(rng) >> 16;
+}
+
+/**
+ * Random number 0 .. lim - 1, multiply and shift instead of division
+ */
+static inline uint8_t led_effect_random8_to(led_effect_rng_t *rng, uint8_t lim)
+{
+    return (led_effect_random8(rng) * lim) >> 8;
+}
+
+/**
+ * Random number min .. lim - 1
+ */
+static inline uint8_t led_effect_random8_between(led_effect_rng_t *rng, uint8_t min, uint8_t lim)
+{
+    return min + led_effect_random8_to(rng, lim - min);
+}
+
+/**
+ * Random number 0 .. lim - 1
+ */
+static inline uint16_t led_effect_random16_to(led_effect_rng_t *rng, uint16_t lim)
+{
+    return (led_effect_random16(rng) * (uint32_t)lim) >> 16;
+}
+
+/**
+ * Four random numbers 0 .. lim - 1 packed in bytes of a word, single
+ * generator step and two multiplications
+ */
+static inline uint32_t led_effect_random8x4_to(led_effect_rng_t *rng, uint8_t lim)
+{
+    uint32_t r = led_effect_random32(rng);
+    // bytes 0 and 2, then 1 and 3, each in its own 16-bit lane
+    uint32_t even = (((r & 0x00ff00ff) * lim) >> 8) & 0x00ff00ff;
+    uint32_t odd = (((r >> 8) & 0x00ff00ff) * lim) & 0xff00ff00;
+    return even | odd;
+}
+
+/**
+ * @brief Fill buffer with random numbers 0 .. lim - 1
+ *
+ * @param rng Random stream
+ * @param buf Buffer
+ * @param len Buffer length, bytes
+ * @param lim Upper limit, exclusive. 0 for full range
+ */
+void led_effect_random_fill(led_effect_rng_t *rng, uint8_t *buf, size_t len, uint8_t lim);
+
+/**
+ * @brief Publish parameters to running effect
+ *
+ * Lock-free, never waits for render side.
+ *
+ * @param pending Parameter block in effect state
+ * @param params `LED_EFFECT_MAX_PARAMS` parameters
+ */
+void led_effect_params_publish(led_effect_params_t *pending, const uint8_t *params);
+
+/**
+ * @brief Take parameters published since the last call
+ *
+ * Call at the start of a frame, after led_effect_begin(). Lock-free, if
+ * parameters are being overwritten all the time, they are taken on one of
+ * the next frames.
+ *
+ * @param pending Parameter block in effect state
+ * @param[out] params `LED_EFFECT_MAX_PARAMS` parameters
+ * @return true if there are new parameters in `params`
+ */
+bool led_effect_params_take(led_effect_params_t *pending, uint8_t *params);
+
+/**
+ * @brief Set time source of all effects
+ *
+ * Default is esp_timer_get_time(). Virtual clock makes effects
+ * reproducible.
+ *
+ * @param source Function returning time in us, NULL for default
+ */
+void led_effect_set_time_source(int64_t (*source)(void));
+
+/**
+ * @brief Get current time of the time source of effect clocks
+ *
+ * @return Time, us
+ */
+int64_t led_effect_time(void);
+
+/**
+ * @brief Begin effect frame
+ *
+ * Calls fb_begin() and advances effect clock.
+ *
+ * @param fb Framebuffer
+ * @param clock Effect clock, zeroed before the first frame
+ * @return `ESP_OK` on success
+ */
+esp_err_t led_effect_begin(framebuffer_t *fb, led_effect_clock_t *clock);
+
+/**
+ * @brief Check if a multiple of `period` reference frames passed since the previous frame
+ *
+ * @param clock Effect clock
+ * @param period Period, reference frames
+ * @return true once every `period` reference frames
+ */
+bool led_effect_every(const led_effect_clock_t *clock, uint32_t period);
+
+/**
+ * @brief Same as beatsin8(), but at effect time
+ *
+ * @param clock Effect clock
+ * @param bpm Beats per minute
+ * @param low Lowest output value
+ * @param high Highest output value
+ * @param phase Phase offset
+ * @return Sine wave value between `low` and `high`
+ */
+uint8_t led_effect_beatsin8(const led_effect_clock_t *clock, uint8_t bpm, uint8_t low, uint8_t high, uint8_t phase);
+
+/**
+ * @brief Init arena on a preallocated buffer
+ *
+ * @param arena Arena descriptor
+ * @param buf Arena memory, `LED_EFFECT_ALIGN` aligned
+ * @param size Size of `buf`, bytes
+ * @return `ESP_OK` on success
+ */
+esp_err_t led_effect_arena_init(led_effect_arena_t *arena, void *buf, size_t size);
+
+/**
+ * @brief Release everything allocated from arena
+ *
+ * @param arena Arena descriptor
+ */
+void led_effect_arena_reset(led_effect_arena_t *arena);
+
+/**
+ * @brief Attach arena to framebuffer
+ *
+ * State of effects rendering into `fb` is allocated from `arena` then.
+ * An arena is attached to a single framebuffer at a time, attaching it
+ * to another one detaches it from the first. There is no limit on the
+ * number of attached arenas.
+ *
+ * @param fb Framebuffer
+ * @param arena Arena descriptor, NULL to detach and use heap
+ * @return `ESP_OK` on success
+ */
+esp_err_t led_effect_arena_attach(framebuffer_t *fb, led_effect_arena_t *arena);
+
+/**
+ * @brief Allocate zeroed effect state
+ *
+ * From arena attached to framebuffer or from heap if there is none.
+ *
+ * @param fb Framebuffer
+ * @param size Size, bytes
+ * @return Pointer to allocated memory or NULL
+ */
+void *led_effect_alloc(framebuffer_t *fb, size_t size);
+
+/**
+ * @brief Free effect state
+ *
+ * Does nothing for arena memory, it is released by led_effect_arena_reset().
+ *
+ * @param fb Framebuffer
+ * @param ptr Memory allocated by led_effect_alloc()
+ */
+void led_effect_free(framebuffer_t *fb, void *ptr);
+
+#ifdef __cplusplus
+}
+#endif
+
+/**@}*/
+
+#endif /* __LED_EFFECTS_EFFECT_H__ */
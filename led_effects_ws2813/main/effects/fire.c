@@ -12,6 +12,8 @@
 #include <stdlib.h>
 
 #include "effects/fire.h"
+#include "effects/tiles.h"
+#include "effects/keyframes.h"
 
 #define CHECK(x) do { esp_err_t __; if ((__ = x) != ESP_OK) return __; } while (0)
 #define CHECK_ARG(VAL) do { if (!(VAL)) return ESP_ERR_INVALID_ARG; } while (0)
@@ -21,17 +23,26 @@
 typedef struct
 {
     rgb_t palette[PALETTE_SIZE];
+    led_effect_clock_t clock;
+    led_effect_params_t pending;
+    led_effect_keyframes_t keys;
 } params_t;
 
+LED_EFFECT_CHECK_STATE(sizeof(params_t), LED_EFFECT_KEYFRAMES_PER_PIXEL);
+
 esp_err_t led_effect_fire_init(framebuffer_t *fb, led_effect_fire_palette_t p)
 {
     CHECK_ARG(fb);
 
     // allocate internal storage
-    fb->internal = calloc(1, sizeof(params_t));
+    fb->internal = led_effect_alloc(fb, sizeof(params_t));
     if (!fb->internal)
         return ESP_ERR_NO_MEM;
 
+    params_t *params = (params_t *)fb->internal;
+    // flames rise slowly, frames between keyframes are interpolated
+    CHECK(led_effect_keyframes_init(fb, &params->keys, &params->clock, led_effect_fire.keyframe_interval));
+
     return led_effect_fire_set_params(fb, p);
 }
 
@@ -44,9 +55,10 @@ static const rgb_t C_YELLOW = { .r = 255, .g = 255, .b = 0 };
 static const rgb_t C_DGREEN = { .r = 0,   .g = 100, .b = 0 };
 static const rgb_t C_BGREEN = { .r = 155, .g = 255, .b = 155 };
 
-esp_err_t led_effect_fire_set_params(framebuffer_t *fb, led_effect_fire_palette_t p)
+// applies published parameters, render side only
+static esp_err_t apply_params(framebuffer_t *fb, const uint8_t *values)
 {
-    CHECK_ARG(fb && fb->internal);
+    led_effect_fire_palette_t p = values[0];
 
     params_t *params = (params_t *)fb->internal;
     switch (p)
@@ -64,33 +76,93 @@ esp_err_t led_effect_fire_set_params(framebuffer_t *fb, led_effect_fire_palette_
     return ESP_OK;
 }
 
+esp_err_t led_effect_fire_set_params(framebuffer_t *fb, led_effect_fire_palette_t p)
+{
+    CHECK_ARG(fb && fb->internal);
+
+    uint8_t values[LED_EFFECT_MAX_PARAMS] = { p };
+    led_effect_params_publish(&((params_t *)fb->internal)->pending, values);
+
+    return ESP_OK;
+}
+
 esp_err_t led_effect_fire_done(framebuffer_t *fb)
 {
     CHECK_ARG(fb && fb->internal);
 
+    led_effect_keyframes_done(fb, &((params_t *)fb->internal)->keys);
+
     // free internal storage
     if (fb->internal)
-        free(fb->internal);
+        led_effect_free(fb, fb->internal);
 
     return ESP_OK;
 }
 
-esp_err_t led_effect_fire_run(framebuffer_t *fb)
+static esp_err_t fire_begin(framebuffer_t *fb)
 {
-    CHECK(fb_begin(fb));
+    CHECK_ARG(fb && fb->internal);
 
     params_t *params = (params_t *)fb->internal;
+    CHECK(led_effect_begin(fb, &params->clock));
+
+    // parameters published since the previous frame
+    uint8_t p[LED_EFFECT_MAX_PARAMS];
+    if (led_effect_params_take(&params->pending, p))
+        CHECK(apply_params(fb, p));
 
-    uint32_t a = esp_timer_get_time() / 1000;
+    return ESP_OK;
+}
 
-    for (size_t x = 0; x < fb->width; x++)
-        for (size_t y = 0; y < fb->height; y++)
+static esp_err_t fire_rows(framebuffer_t *fb, size_t y0, size_t y1)
+{
+    params_t *params = (params_t *)fb->internal;
+    uint32_t a = params->clock.ms;
+
+    // flames are computed bottom up, row `y` of frame is row `height - 1 - y` of noise
+    for (size_t fy = y0; fy < y1; fy++)
+    {
+        size_t y = fb->height - 1 - fy;
+        for (size_t x = 0; x < fb->width; x++)
         {
             uint8_t idx = qsub8(inoise8_3d(x * 60, y * 60 + a, a / 3), abs8(y - (fb->height - 1)) * 255 / (fb->height - 1));
             rgb_t c = color_from_palette_rgb(params->palette, PALETTE_SIZE, idx, 255, true);
-            fb_set_pixel_rgb(fb, x, fb->height - y - 1, c);
+            fb_set_pixel_rgb(fb, x, fy, c);
         }
+    }
+
+    return ESP_OK;
+}
+
+esp_err_t led_effect_fire_run(framebuffer_t *fb)
+{
+    CHECK_ARG(fb && fb->internal);
+
+    return led_effect_keyframes_render(fb, &led_effect_fire, &((params_t *)fb->internal)->keys);
+}
 
-    return fb_end(fb);
+static esp_err_t fire_update_params(framebuffer_t *fb, const uint8_t *p)
+{
+    return led_effect_fire_set_params(fb, p[0]);
+}
+
+static esp_err_t fire_init_params(framebuffer_t *fb, const uint8_t *p)
+{
+    return led_effect_fire_init(fb, p[0]);
 }
 
+const led_effect_t led_effect_fire = {
+    .name = "Fire",
+    .init = fire_init_params,
+    .run = led_effect_fire_run,
+    .done = led_effect_fire_done,
+    .set_params = fire_update_params,
+    .begin = fire_begin,
+    .rows = fire_rows,
+    .keyframe_interval = 3,
+    .num_params = 1,
+    .params = { { 0, 2 } },
+    .state_size = sizeof(params_t),
+    .state_per_pixel = LED_EFFECT_KEYFRAMES_PER_PIXEL,
+    .cycles_per_pixel = 500,
+};
@@ -15,6 +15,8 @@
 
 #include <framebuffer.h>
 
+#include "effects/effect.h"
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -25,6 +27,8 @@ typedef enum {
     FIRE_PALETTE_GREEN
 } led_effect_fire_palette_t;
 
+extern const led_effect_t led_effect_fire;
+
 esp_err_t led_effect_fire_init(framebuffer_t *fb, led_effect_fire_palette_t p);
 
 esp_err_t led_effect_fire_set_params(framebuffer_t *fb, led_effect_fire_palette_t p);
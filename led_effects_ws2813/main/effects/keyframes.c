@@ -0,0 +1,136 @@
+/**
+ * @file keyframes.c
+ *
+ * Interpolation of frames of slow and smooth effects
+ */
+#include <string.h>
+
+#include "effects/keyframes.h"
+#include "effects/tiles.h"
+#include "player/blend.h"
+
+#define CHECK(x) do { esp_err_t __; if ((__ = x) != ESP_OK) return __; } while (0)
+#define CHECK_ARG(VAL) do { if (!(VAL)) return ESP_ERR_INVALID_ARG; } while (0)
+
+esp_err_t led_effect_keyframes_init(framebuffer_t *fb, led_effect_keyframes_t *kf,
+        const led_effect_clock_t *clock, uint8_t interval)
+{
+    CHECK_ARG(fb && kf && clock);
+
+    memset(kf, 0, sizeof(led_effect_keyframes_t));
+    kf->clock = clock;
+    kf->interval = 1;
+#ifdef CONFIG_EXAMPLE_EFFECT_KEYFRAMES
+    if (interval > 1)
+    {
+        kf->keys = led_effect_alloc(fb, 3 * fb->width * fb->height * sizeof(rgb_t));
+        if (!kf->keys)
+            return ESP_ERR_NO_MEM;
+        kf->interval = interval;
+    }
+#endif
+
+    return ESP_OK;
+}
+
+esp_err_t led_effect_keyframes_done(framebuffer_t *fb, led_effect_keyframes_t *kf)
+{
+    CHECK_ARG(fb && kf);
+
+    if (kf->keys)
+        led_effect_free(fb, kf->keys);
+    kf->keys = NULL;
+
+    return ESP_OK;
+}
+
+// compute a share of rows of the next keyframe, frame is started
+static esp_err_t compute_rows(framebuffer_t *fb, const led_effect_t *effect, led_effect_keyframes_t *kf)
+{
+    size_t pixels = fb->width * fb->height;
+    size_t y1 = kf->row + (fb->height + kf->interval - 1) / kf->interval;
+    if (y1 > fb->height)
+        y1 = fb->height;
+
+    // effect draws into keyframe instead of framebuffer
+    rgb_t *data = fb->data;
+    fb->data = kf->keys + kf->next * pixels;
+    esp_err_t res = led_effect_render_row_range(fb, effect, kf->row, y1);
+    fb->data = data;
+    CHECK(res);
+
+    kf->row = y1;
+    return ESP_OK;
+}
+
+// the next keyframe is complete, it becomes the newer one
+static void rotate(led_effect_keyframes_t *kf, int64_t now)
+{
+    if (!kf->computed)
+    {
+        // nothing to interpolate from yet
+        kf->older = kf->newer = kf->next;
+        kf->older_us = kf->newer_us = kf->next_us;
+        kf->next = (kf->next + 1) % 3;
+        kf->computed = 1;
+    }
+    else
+    {
+        kf->older = kf->newer;
+        kf->older_us = kf->newer_us;
+        kf->newer = kf->next;
+        kf->newer_us = kf->next_us;
+        kf->next = 3 - kf->older - kf->newer;
+        kf->computed = 2;
+    }
+    kf->row = 0;
+    kf->shown_us = now;
+}
+
+esp_err_t led_effect_keyframes_render(framebuffer_t *fb, const led_effect_t *effect, led_effect_keyframes_t *kf)
+{
+    CHECK_ARG(fb && effect && kf);
+
+    if (!kf->keys)
+        return led_effect_render(fb, effect);
+
+    // parameters and clock of the keyframe are taken at its first rows,
+    // the frame is at the same time as the effect clock then
+    int64_t now;
+    if (!kf->row)
+    {
+        CHECK(effect->begin(fb));
+        now = kf->next_us = kf->clock->start + kf->clock->now;
+    }
+    else
+    {
+        CHECK(fb_begin(fb));
+        now = led_effect_time();
+    }
+
+    esp_err_t res = compute_rows(fb, effect, kf);
+    if (res != ESP_OK)
+    {
+        fb_end(fb);
+        return res;
+    }
+    if (kf->row == fb->height)
+        rotate(kf, now);
+
+    size_t pixels = fb->width * fb->height;
+    if (!kf->computed)
+    {
+        memset(fb->data, 0, pixels * sizeof(rgb_t));
+        return fb_end(fb);
+    }
+
+    // from the older keyframe towards the newer one by effect time, the
+    // older one was shown when the newer one was computed
+    int64_t span = kf->newer_us - kf->older_us;
+    int64_t alpha = span > 0 ? (now - kf->shown_us) * 256 / span : 0;
+    if (alpha > 255)
+        alpha = 255;
+    blend_rgb(fb->data, kf->keys + kf->older * pixels, kf->keys + kf->newer * pixels, pixels, alpha);
+
+    return fb_end(fb);
+}
@@ -0,0 +1,111 @@
+/**
+ * @file keyframes.h
+ *
+ * @defgroup led_effect_keyframes led_effect_keyframes
+ * @{
+ *
+ * Interpolation of frames of slow and smooth effects
+ *
+ * Effects with `begin`, `rows` and `keyframe_interval` in their descriptor
+ * can compute only every `keyframe_interval`-th frame (keyframe). The
+ * computation of a keyframe is spread over `keyframe_interval` frames,
+ * every frame computes its share of rows, so no frame costs a full one.
+ * Two last keyframes are kept in effect state with the one being
+ * computed, frames are blended from them with blend_rgb(), which is much
+ * cheaper than computing a frame. The weight of the newer keyframe comes
+ * from the effect time between the keyframes, not from a frame count, so
+ * the animation keeps its speed at any frame rate.
+ *
+ * The animation is shown two keyframe intervals late, so it is always
+ * interpolated between two computed keyframes and never extrapolated.
+ * Until the first keyframe is computed the frame is black, then it shows
+ * the first keyframe until the second one is.
+ *
+ * Enabled with CONFIG_EXAMPLE_EFFECT_KEYFRAMES, without it every frame is
+ * computed and keyframes take no memory.
+ */
+#ifndef __LED_EFFECTS_KEYFRAMES_H__
+#define __LED_EFFECTS_KEYFRAMES_H__
+
+#include <framebuffer.h>
+
+#include "effects/effect.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Effect state per pixel taken by keyframes
+ */
+#ifdef CONFIG_EXAMPLE_EFFECT_KEYFRAMES
+#define LED_EFFECT_KEYFRAMES_PER_PIXEL (3 * sizeof(rgb_t))
+#else
+#define LED_EFFECT_KEYFRAMES_PER_PIXEL 0
+#endif
+
+/**
+ * Keyframes of effect, part of effect state
+ */
+typedef struct
+{
+    rgb_t *keys;                      ///< Three keyframes, NULL if every frame is computed
+    const led_effect_clock_t *clock;  ///< Effect clock, advanced by `begin`
+    uint8_t older;                    ///< Index of the older keyframe in `keys`
+    uint8_t newer;                    ///< Index of the newer keyframe, same as `older` until two are computed
+    uint8_t next;                     ///< Index of the keyframe being computed
+    uint8_t computed;                 ///< Keyframes computed, up to 2
+    uint8_t interval;                 ///< Frames per keyframe
+    size_t row;                       ///< Rows of the next keyframe computed
+    int64_t older_us;                 ///< Effect time of the older keyframe, us
+    int64_t newer_us;                 ///< Effect time of the newer keyframe, us
+    int64_t next_us;                  ///< Effect time of the keyframe being computed, us
+    int64_t shown_us;                 ///< Time the older keyframe was shown first, us
+} led_effect_keyframes_t;
+
+/**
+ * @brief Allocate keyframes
+ *
+ * Call from effect init.
+ *
+ * @param fb Framebuffer
+ * @param kf Keyframes
+ * @param clock Effect clock advanced by `begin` of the effect, keyframes
+ *              take their time from it
+ * @param interval Frames per keyframe, `keyframe_interval` of descriptor
+ * @return `ESP_OK` on success
+ */
+esp_err_t led_effect_keyframes_init(framebuffer_t *fb, led_effect_keyframes_t *kf,
+        const led_effect_clock_t *clock, uint8_t interval);
+
+/**
+ * @brief Free keyframes
+ *
+ * @param fb Framebuffer
+ * @param kf Keyframes
+ * @return `ESP_OK` on success
+ */
+esp_err_t led_effect_keyframes_done(framebuffer_t *fb, led_effect_keyframes_t *kf);
+
+/**
+ * @brief Render frame of effect, compute rows of the next keyframe
+ *
+ * Keyframes are computed with `begin` and `rows` like by
+ * led_effect_render(), on all workers if they are set. `begin` is called
+ * once per keyframe, at its first rows. Without keyframes it is
+ * led_effect_render().
+ *
+ * @param fb Framebuffer
+ * @param effect Effect descriptor
+ * @param kf Keyframes
+ * @return `ESP_OK` on success
+ */
+esp_err_t led_effect_keyframes_render(framebuffer_t *fb, const led_effect_t *effect, led_effect_keyframes_t *kf);
+
+#ifdef __cplusplus
+}
+#endif
+
+/**@}*/
+
+#endif /* __LED_EFFECTS_KEYFRAMES_H__ */
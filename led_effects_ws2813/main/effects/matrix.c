@@ -15,17 +15,25 @@
 typedef struct
 {
     uint8_t density;
+    led_effect_clock_t clock;
+    led_effect_params_t pending;
+    led_effect_rng_t rng;
 } params_t;
 
+LED_EFFECT_CHECK_STATE(sizeof(params_t), 0);
+
 esp_err_t led_effect_matrix_init(framebuffer_t *fb, uint8_t density)
 {
     CHECK_ARG(fb);
 
     // allocate internal storage
-    fb->internal = calloc(1, sizeof(params_t));
+    fb->internal = led_effect_alloc(fb, sizeof(params_t));
     if (!fb->internal)
         return ESP_ERR_NO_MEM;
 
+    // seed random stream
+    led_effect_rng_init(&((params_t *)fb->internal)->rng);
+
     return led_effect_matrix_set_params(fb, density);
 }
 
@@ -35,14 +43,15 @@ esp_err_t led_effect_matrix_done(framebuffer_t *fb)
 
     // free internal storage
     if (fb->internal)
-        free(fb->internal);
+        led_effect_free(fb, fb->internal);
 
     return ESP_OK;
 }
 
-esp_err_t led_effect_matrix_set_params(framebuffer_t *fb, uint8_t density)
+// applies published parameters, render side only
+static esp_err_t apply_params(framebuffer_t *fb, const uint8_t *p)
 {
-    CHECK_ARG(fb && fb->internal);
+    uint8_t density = p[0];
 
     params_t *params = (params_t *)fb->internal;
     params->density = 255 - density;
@@ -50,6 +59,16 @@ esp_err_t led_effect_matrix_set_params(framebuffer_t *fb, uint8_t density)
     return ESP_OK;
 }
 
+esp_err_t led_effect_matrix_set_params(framebuffer_t *fb, uint8_t density)
+{
+    CHECK_ARG(fb && fb->internal);
+
+    uint8_t p[LED_EFFECT_MAX_PARAMS] = { density };
+    led_effect_params_publish(&((params_t *)fb->internal)->pending, p);
+
+    return ESP_OK;
+}
+
 #define MATRIX_START_COLOR   0x9bf800
 #define MATRIX_DIM_COLOR     0x558800
 #define MATRIX_STEP          0x0a1000
@@ -57,12 +76,9 @@ esp_err_t led_effect_matrix_set_params(framebuffer_t *fb, uint8_t density)
 #define MATRIX_OFF_THRESH    0x030000
 #define MATRIX_DIMMEST_COLOR 0x020300
 
-esp_err_t led_effect_matrix_run(framebuffer_t *fb)
+// single step of simulation at reference frame rate
+static void step(framebuffer_t *fb, params_t *params)
 {
-    CHECK(fb_begin(fb));
-
-    params_t *params = (params_t *)fb->internal;
-
     for (size_t x = 0; x < fb->width; x++)
     {
         // process matrix from bottom to the second line from the top
@@ -78,10 +94,10 @@ esp_err_t led_effect_matrix_run(framebuffer_t *fb)
             uint32_t upper_code = rgb_to_code(upper_color);
 
             // if above is max brightness, ignore this fact with some probability or move tail down
-            if (upper_code == MATRIX_START_COLOR && random8_to(7 * fb->height) != 0)
+            if (upper_code == MATRIX_START_COLOR && led_effect_random16_to(&params->rng, 7 * fb->height) != 0)
                 fb_set_pixel_rgb(fb, x, y, upper_color);
             // if current pixel is off, light up new tails with some probability
-            else if (cur_code == 0 && random8_to(params->density) == 0)
+            else if (cur_code == 0 && led_effect_random8_to(&params->rng, params->density) == 0)
                 fb_set_pixel_rgb(fb, x, y, rgb_from_code(MATRIX_START_COLOR));
             // if current pixel is almost off, try to make the fading out slower
             else if (cur_code <= MATRIX_ALMOST_OFF)
@@ -107,7 +123,7 @@ esp_err_t led_effect_matrix_run(framebuffer_t *fb)
         // if current top pixel is off, fill it with some probability
         if (cur_code == 0)
         {
-            if (random8_to(params->density) == 0)
+            if (led_effect_random8_to(&params->rng, params->density) == 0)
                 fb_set_pixel_rgb(fb, x, fb->height - 1, rgb_from_code(MATRIX_START_COLOR));
         }
         // if current pixel is almost off, try to make the fading out slower
@@ -125,6 +141,44 @@ esp_err_t led_effect_matrix_run(framebuffer_t *fb)
             // otherwise just lower the brightness one step
             fb_set_pixel_rgb(fb, x, fb->height - 1, rgb_from_code(cur_code - MATRIX_STEP));
     }
+}
+
+esp_err_t led_effect_matrix_run(framebuffer_t *fb)
+{
+    CHECK_ARG(fb && fb->internal);
+
+    params_t *params = (params_t *)fb->internal;
+    CHECK(led_effect_begin(fb, &params->clock));
+
+    // parameters published since the previous frame
+    uint8_t p[LED_EFFECT_MAX_PARAMS];
+    if (led_effect_params_take(&params->pending, p))
+        CHECK(apply_params(fb, p));
+
+    for (uint32_t i = 0; i < params->clock.steps; i++)
+        step(fb, params);
 
     return fb_end(fb);
 }
+
+static esp_err_t matrix_update_params(framebuffer_t *fb, const uint8_t *p)
+{
+    return led_effect_matrix_set_params(fb, p[0]);
+}
+
+static esp_err_t matrix_init_params(framebuffer_t *fb, const uint8_t *p)
+{
+    return led_effect_matrix_init(fb, p[0]);
+}
+
+const led_effect_t led_effect_matrix = {
+    .name = "Matrix",
+    .init = matrix_init_params,
+    .run = led_effect_matrix_run,
+    .done = led_effect_matrix_done,
+    .set_params = matrix_update_params,
+    .num_params = 1,
+    .params = { { 10, 249 } },
+    .state_size = sizeof(params_t),
+    .cycles_per_pixel = 40,
+};
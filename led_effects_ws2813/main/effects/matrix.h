@@ -12,10 +12,14 @@
 
 #include <framebuffer.h>
 
+#include "effects/effect.h"
+
 #ifdef __cplusplus
 extern "C" {
 #endif
 
+extern const led_effect_t led_effect_matrix;
+
 esp_err_t led_effect_matrix_init(framebuffer_t *fb, uint8_t density);
 
 esp_err_t led_effect_matrix_done(framebuffer_t *fb);
@@ -10,6 +10,8 @@
 #include <stdlib.h>
 
 #include "noise.h"
+#include "effects/tiles.h"
+#include "effects/keyframes.h"
 
 #define CHECK(x) do { esp_err_t __; if ((__ = x) != ESP_OK) return __; } while (0)
 #define CHECK_ARG(VAL) do { if (!(VAL)) return ESP_ERR_INVALID_ARG; } while (0)
@@ -21,16 +23,24 @@ typedef struct
     uint16_t z_pos;
     uint16_t x_offs;
     uint8_t hue;
+    led_effect_clock_t clock;
+    led_effect_params_t pending;
+    led_effect_keyframes_t keys;
 } params_t;
 
+LED_EFFECT_CHECK_STATE(sizeof(params_t), LED_EFFECT_KEYFRAMES_PER_PIXEL);
+
 esp_err_t led_effect_noise_init(framebuffer_t *fb, uint8_t scale, uint8_t speed)
 {
     CHECK_ARG(fb);
 
-    fb->internal = calloc(1, sizeof(params_t));
+    fb->internal = led_effect_alloc(fb, sizeof(params_t));
     if (!fb->internal)
         return ESP_ERR_NO_MEM;
 
+    params_t *params = (params_t *)fb->internal;
+    CHECK(led_effect_keyframes_init(fb, &params->keys, &params->clock, led_effect_noise.keyframe_interval));
+
     return led_effect_noise_set_params(fb, scale, speed);
 }
 
@@ -39,14 +49,19 @@ esp_err_t led_effect_noise_done(framebuffer_t *fb)
     CHECK_ARG(fb);
 
     if (fb->internal)
-        free(fb->internal);
+    {
+        led_effect_keyframes_done(fb, &((params_t *)fb->internal)->keys);
+        led_effect_free(fb, fb->internal);
+    }
 
     return ESP_OK;
 }
 
-esp_err_t led_effect_noise_set_params(framebuffer_t *fb, uint8_t scale, uint8_t speed)
+// applies published parameters, render side only
+static esp_err_t apply_params(framebuffer_t *fb, const uint8_t *p)
 {
-    CHECK_ARG(fb && fb->internal);
+    uint8_t scale = p[0];
+    uint8_t speed = p[1];
 
     params_t *params = (params_t *)fb->internal;
     params->scale = scale;
@@ -55,24 +70,78 @@ esp_err_t led_effect_noise_set_params(framebuffer_t *fb, uint8_t scale, uint8_t
     return ESP_OK;
 }
 
-esp_err_t led_effect_noise_run(framebuffer_t *fb)
+esp_err_t led_effect_noise_set_params(framebuffer_t *fb, uint8_t scale, uint8_t speed)
+{
+    CHECK_ARG(fb && fb->internal);
+
+    uint8_t p[LED_EFFECT_MAX_PARAMS] = { scale, speed };
+    led_effect_params_publish(&((params_t *)fb->internal)->pending, p);
+
+    return ESP_OK;
+}
+
+static esp_err_t noise_begin(framebuffer_t *fb)
 {
-    CHECK(fb_begin(fb));
+    CHECK_ARG(fb && fb->internal);
 
     params_t *params = (params_t *)fb->internal;
+    CHECK(led_effect_begin(fb, &params->clock));
+
+    // parameters published since the previous frame
+    uint8_t p[LED_EFFECT_MAX_PARAMS];
+    if (led_effect_params_take(&params->pending, p))
+        CHECK(apply_params(fb, p));
 
-    if (!(fb->frame_num % 30))
-        params->x_offs++;
+    params->x_offs = params->clock.frames / 30;
+    params->z_pos += params->speed * params->clock.steps;
+    params->hue = params->clock.frames;
 
-    params->z_pos += params->speed;
-    params->hue++;
+    return ESP_OK;
+}
 
-    for (int x = 0; x < fb->width; x++)
-        for (int y = 0; y < fb->height; y++)
+static esp_err_t noise_rows(framebuffer_t *fb, size_t y0, size_t y1)
+{
+    params_t *params = (params_t *)fb->internal;
+
+    for (size_t y = y0; y < y1; y++)
+        for (size_t x = 0; x < fb->width; x++)
         {
             uint8_t noise = inoise8_3d(x * params->scale, y * params->scale, params->z_pos);
             fb_set_pixel_hsv(fb, x, y, hsv_from_values(params->hue + noise, 255, 255));
         }
 
-    return fb_end(fb);
+    return ESP_OK;
 }
+
+esp_err_t led_effect_noise_run(framebuffer_t *fb)
+{
+    CHECK_ARG(fb && fb->internal);
+
+    return led_effect_keyframes_render(fb, &led_effect_noise, &((params_t *)fb->internal)->keys);
+}
+
+static esp_err_t noise_update_params(framebuffer_t *fb, const uint8_t *p)
+{
+    return led_effect_noise_set_params(fb, p[0], p[1]);
+}
+
+static esp_err_t noise_init_params(framebuffer_t *fb, const uint8_t *p)
+{
+    return led_effect_noise_init(fb, p[0], p[1]);
+}
+
+const led_effect_t led_effect_noise = {
+    .name = "Noise",
+    .init = noise_init_params,
+    .run = led_effect_noise_run,
+    .done = led_effect_noise_done,
+    .set_params = noise_update_params,
+    .begin = noise_begin,
+    .rows = noise_rows,
+    .keyframe_interval = 2,
+    .num_params = 2,
+    .params = { { 10, 99 }, { 1, 49 } },
+    .state_size = sizeof(params_t),
+    .state_per_pixel = LED_EFFECT_KEYFRAMES_PER_PIXEL,
+    .cycles_per_pixel = 400,
+};
@@ -13,10 +13,14 @@
 
 #include <framebuffer.h>
 
+#include "effects/effect.h"
+
 #ifdef __cplusplus
 extern "C" {
 #endif
 
+extern const led_effect_t led_effect_noise;
+
 esp_err_t led_effect_noise_init(framebuffer_t *fb, uint8_t scale, uint8_t speed);
 
 esp_err_t led_effect_noise_done(framebuffer_t *fb);
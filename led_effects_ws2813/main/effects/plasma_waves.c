@@ -7,6 +7,7 @@
 #include <lib8tion.h>
 #include <stdlib.h>
 #include "effects/plasma_waves.h"
+#include "effects/tiles.h"
 
 #define CHECK(x) do { esp_err_t __; if ((__ = x) != ESP_OK) return __; } while (0)
 #define CHECK_ARG(VAL) do { if (!(VAL)) return ESP_ERR_INVALID_ARG; } while (0)
@@ -35,13 +36,18 @@ static const uint8_t exp_gamma[256] = {
 typedef struct
 {
     uint8_t speed;
+    uint32_t phase[3]; // of waves, 8.8 fixed point
+    led_effect_clock_t clock;
+    led_effect_params_t pending;
 } params_t;
 
+LED_EFFECT_CHECK_STATE(sizeof(params_t), 0);
+
 esp_err_t led_effect_plasma_waves_init(framebuffer_t *fb, uint8_t speed)
 {
     CHECK_ARG(fb);
 
-    fb->internal = calloc(1, sizeof(params_t));
+    fb->internal = led_effect_alloc(fb, sizeof(params_t));
     if (!fb->internal)
         return ESP_ERR_NO_MEM;
 
@@ -53,14 +59,15 @@ esp_err_t led_effect_plasma_waves_done(framebuffer_t *fb)
     CHECK_ARG(fb);
 
     if (fb->internal)
-        free(fb->internal);
+        led_effect_free(fb, fb->internal);
 
     return ESP_OK;
 }
 
-esp_err_t led_effect_plasma_waves_set_params(framebuffer_t *fb, uint8_t speed)
+// applies published parameters, render side only
+static esp_err_t apply_params(framebuffer_t *fb, const uint8_t *p)
 {
-    CHECK_ARG(fb && fb->internal);
+    uint8_t speed = p[0];
 
     params_t *params = (params_t *)fb->internal;
     params->speed = scale8_video(256 - speed, 150);
@@ -69,17 +76,44 @@ esp_err_t led_effect_plasma_waves_set_params(framebuffer_t *fb, uint8_t speed)
     return ESP_OK;
 }
 
-esp_err_t led_effect_plasma_waves_run(framebuffer_t *fb)
+esp_err_t led_effect_plasma_waves_set_params(framebuffer_t *fb, uint8_t speed)
 {
-    CHECK(fb_begin(fb));
+    CHECK_ARG(fb && fb->internal);
+
+    uint8_t p[LED_EFFECT_MAX_PARAMS] = { speed };
+    led_effect_params_publish(&((params_t *)fb->internal)->pending, p);
+
+    return ESP_OK;
+}
+
+static esp_err_t plasma_waves_begin(framebuffer_t *fb)
+{
+    CHECK_ARG(fb && fb->internal);
+
+    params_t *params = (params_t *)fb->internal;
+    CHECK(led_effect_begin(fb, &params->clock));
+
+    // parameters published since the previous frame
+    uint8_t p[LED_EFFECT_MAX_PARAMS];
+    if (led_effect_params_take(&params->pending, p))
+        CHECK(apply_params(fb, p));
+
+    params->phase[0] += (42 << 8) * params->clock.steps / params->speed;
+    params->phase[1] += (35 << 8) * params->clock.steps / params->speed;
+    params->phase[2] += (38 << 8) * params->clock.steps / params->speed;
 
+    return ESP_OK;
+}
+
+static esp_err_t plasma_waves_rows(framebuffer_t *fb, size_t y0, size_t y1)
+{
     params_t *params = (params_t *)fb->internal;
 
-    uint8_t t1 = cos8((42 * fb->frame_num) / params->speed);
-    uint8_t t2 = cos8((35 * fb->frame_num) / params->speed);
-    uint8_t t3 = cos8((38 * fb->frame_num) / params->speed);
+    uint8_t t1 = cos8(params->phase[0] >> 8);
+    uint8_t t2 = cos8(params->phase[1] >> 8);
+    uint8_t t3 = cos8(params->phase[2] >> 8);
 
-    for (uint16_t y = 0; y < fb->height; y++)
+    for (uint16_t y = y0; y < y1; y++)
     {
         for (uint16_t x = 0; x < fb->width; x++)
         {
@@ -97,5 +131,34 @@ esp_err_t led_effect_plasma_waves_run(framebuffer_t *fb)
         }
     }
 
-    return fb_end(fb);
+    return ESP_OK;
+}
+
+esp_err_t led_effect_plasma_waves_run(framebuffer_t *fb)
+{
+    return led_effect_render(fb, &led_effect_plasma_waves);
 }
+
+static esp_err_t plasma_waves_update_params(framebuffer_t *fb, const uint8_t *p)
+{
+    return led_effect_plasma_waves_set_params(fb, p[0]);
+}
+
+static esp_err_t plasma_waves_init_params(framebuffer_t *fb, const uint8_t *p)
+{
+    return led_effect_plasma_waves_init(fb, p[0]);
+}
+
+const led_effect_t led_effect_plasma_waves = {
+    .name = "Plasma waves",
+    .init = plasma_waves_init_params,
+    .run = led_effect_plasma_waves_run,
+    .done = led_effect_plasma_waves_done,
+    .set_params = plasma_waves_update_params,
+    .begin = plasma_waves_begin,
+    .rows = plasma_waves_rows,
+    .num_params = 1,
+    .params = { { 50, 254 } },
+    .state_size = sizeof(params_t),
+    .cycles_per_pixel = 150,
+};
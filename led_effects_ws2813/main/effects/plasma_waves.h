@@ -13,10 +13,14 @@
 
 #include <framebuffer.h>
 
+#include "effects/effect.h"
+
 #ifdef __cplusplus
 extern "C" {
 #endif
 
+extern const led_effect_t led_effect_plasma_waves;
+
 esp_err_t led_effect_plasma_waves_init(framebuffer_t *fb, uint8_t speed);
 
 esp_err_t led_effect_plasma_waves_done(framebuffer_t *fb);
@@ -18,17 +18,25 @@ typedef struct
     uint8_t hue;
     uint8_t density;
     uint8_t tail;
+    led_effect_clock_t clock;
+    led_effect_params_t pending;
+    led_effect_rng_t rng;
 } params_t;
 
+LED_EFFECT_CHECK_STATE(sizeof(params_t), 0);
+
 esp_err_t led_effect_rain_init(framebuffer_t *fb, led_effect_rain_mode_t mode, uint8_t hue, uint8_t density, uint8_t tail)
 {
     CHECK_ARG(fb);
 
     // allocate internal storage
-    fb->internal = calloc(1, sizeof(params_t));
+    fb->internal = led_effect_alloc(fb, sizeof(params_t));
     if (!fb->internal)
         return ESP_ERR_NO_MEM;
 
+    // seed random stream
+    led_effect_rng_init(&((params_t *)fb->internal)->rng);
+
     return led_effect_rain_set_params(fb, mode, hue, density, tail);
 }
 
@@ -38,14 +46,18 @@ esp_err_t led_effect_rain_done(framebuffer_t *fb)
 
     // free internal storage
     if (fb->internal)
-        free(fb->internal);
+        led_effect_free(fb, fb->internal);
 
     return ESP_OK;
 }
 
-esp_err_t led_effect_rain_set_params(framebuffer_t *fb, led_effect_rain_mode_t mode, uint8_t hue, uint8_t density, uint8_t tail)
+// applies published parameters, render side only
+static esp_err_t apply_params(framebuffer_t *fb, const uint8_t *p)
 {
-    CHECK_ARG(fb && fb->internal);
+    led_effect_rain_mode_t mode = p[0];
+    uint8_t hue = p[1];
+    uint8_t density = p[2];
+    uint8_t tail = p[3];
 
     params_t *params = (params_t *)fb->internal;
     params->mode = mode;
@@ -56,26 +68,71 @@ esp_err_t led_effect_rain_set_params(framebuffer_t *fb, led_effect_rain_mode_t m
     return ESP_OK;
 }
 
-esp_err_t led_effect_rain_run(framebuffer_t *fb)
+esp_err_t led_effect_rain_set_params(framebuffer_t *fb, led_effect_rain_mode_t mode, uint8_t hue, uint8_t density, uint8_t tail)
 {
-    CHECK(fb_begin(fb));
+    CHECK_ARG(fb && fb->internal);
 
-    params_t *params = (params_t *)fb->internal;
+    uint8_t p[LED_EFFECT_MAX_PARAMS] = { mode, hue, density, tail };
+    led_effect_params_publish(&((params_t *)fb->internal)->pending, p);
+
+    return ESP_OK;
+}
 
+// single step of simulation at reference frame rate
+static void step(framebuffer_t *fb, params_t *params)
+{
     for (size_t x = 0; x < fb->width; x++)
     {
         rgb_t c;
         fb_get_pixel_rgb(fb, x, fb->height - 1, &c);
-        if (!rgb_luma(c) && random8_to(params->density) == 0)
+        if (!rgb_luma(c) && led_effect_random8_to(&params->rng, params->density) == 0)
             fb_set_pixel_hsv(fb, x, fb->height - 1,
-                    hsv_from_values(params->mode == RAIN_MODE_SINGLE_COLOR ? params->hue : random8(), 255, 255));
+                    hsv_from_values(params->mode == RAIN_MODE_SINGLE_COLOR ? params->hue : led_effect_random8(&params->rng), 255, 255));
         else
         {
-            c = rgb_scale(c, params->tail + random8_to(100) - 50);
+            c = rgb_scale(c, params->tail + led_effect_random8_to(&params->rng, 100) - 50);
             fb_set_pixel_rgb(fb, x, fb->height - 1, rgb_luma(c) < 3 ? rgb_from_values(0, 0, 0) : c);
         }
     }
     fb_shift(fb, 1, FB_SHIFT_DOWN);
+}
+
+esp_err_t led_effect_rain_run(framebuffer_t *fb)
+{
+    CHECK_ARG(fb && fb->internal);
+
+    params_t *params = (params_t *)fb->internal;
+    CHECK(led_effect_begin(fb, &params->clock));
+
+    // parameters published since the previous frame
+    uint8_t p[LED_EFFECT_MAX_PARAMS];
+    if (led_effect_params_take(&params->pending, p))
+        CHECK(apply_params(fb, p));
+
+    for (uint32_t i = 0; i < params->clock.steps; i++)
+        step(fb, params);
 
     return fb_end(fb);
 }
+
+static esp_err_t rain_update_params(framebuffer_t *fb, const uint8_t *p)
+{
+    return led_effect_rain_set_params(fb, p[0], p[1], p[2], p[3]);
+}
+
+static esp_err_t rain_init_params(framebuffer_t *fb, const uint8_t *p)
+{
+    return led_effect_rain_init(fb, p[0], p[1], p[2], p[3]);
+}
+
+const led_effect_t led_effect_rain = {
+    .name = "Rain",
+    .init = rain_init_params,
+    .run = led_effect_rain_run,
+    .done = led_effect_rain_done,
+    .set_params = rain_update_params,
+    .num_params = 4,
+    .params = { { 0, 1 }, { 0, 255 }, { 0, 99 }, { 100, 199 } },
+    .state_size = sizeof(params_t),
+    .cycles_per_pixel = 40,
+};
@@ -12,6 +12,8 @@
 
 #include <framebuffer.h>
 
+#include "effects/effect.h"
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -21,6 +23,8 @@ typedef enum {
     RAIN_MODE_RAINBOW
 } led_effect_rain_mode_t;
 
+extern const led_effect_t led_effect_rain;
+
 esp_err_t led_effect_rain_init(framebuffer_t *fb, led_effect_rain_mode_t mode, uint8_t hue, uint8_t density, uint8_t tail);
 
 esp_err_t led_effect_rain_done(framebuffer_t *fb);
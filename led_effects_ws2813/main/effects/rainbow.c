@@ -21,14 +21,19 @@ typedef struct
     led_effect_rainbow_direction_t direction;
     uint8_t scale;
     uint8_t speed;
+    uint8_t hue;
+    led_effect_clock_t clock;
+    led_effect_params_t pending;
 } params_t;
 
+LED_EFFECT_CHECK_STATE(sizeof(params_t), 0);
+
 esp_err_t led_effect_rainbow_init(framebuffer_t *fb, led_effect_rainbow_direction_t direction,
         uint8_t scale, uint8_t speed)
 {
     CHECK_ARG(fb);
 
-    fb->internal = calloc(1, sizeof(params_t));
+    fb->internal = led_effect_alloc(fb, sizeof(params_t));
     if (!fb->internal)
         return ESP_ERR_NO_MEM;
 
@@ -40,15 +45,17 @@ esp_err_t led_effect_rainbow_done(framebuffer_t *fb)
     CHECK_ARG(fb);
 
     if (fb->internal)
-        free(fb->internal);
+        led_effect_free(fb, fb->internal);
 
     return ESP_OK;
 }
 
-esp_err_t led_effect_rainbow_set_params(framebuffer_t *fb, led_effect_rainbow_direction_t direction,
-        uint8_t scale, uint8_t speed)
+// applies published parameters, render side only
+static esp_err_t apply_params(framebuffer_t *fb, const uint8_t *p)
 {
-    CHECK_ARG(fb && fb->internal);
+    led_effect_rainbow_direction_t direction = p[0];
+    uint8_t scale = p[1];
+    uint8_t speed = p[2];
 
     params_t *params = (params_t *)fb->internal;
     params->direction = direction;
@@ -58,11 +65,30 @@ esp_err_t led_effect_rainbow_set_params(framebuffer_t *fb, led_effect_rainbow_di
     return ESP_OK;
 }
 
+esp_err_t led_effect_rainbow_set_params(framebuffer_t *fb, led_effect_rainbow_direction_t direction,
+        uint8_t scale, uint8_t speed)
+{
+    CHECK_ARG(fb && fb->internal);
+
+    uint8_t p[LED_EFFECT_MAX_PARAMS] = { direction, scale, speed };
+    led_effect_params_publish(&((params_t *)fb->internal)->pending, p);
+
+    return ESP_OK;
+}
+
 esp_err_t led_effect_rainbow_run(framebuffer_t *fb)
 {
-    CHECK(fb_begin(fb));
+    CHECK_ARG(fb && fb->internal);
 
     params_t *params = (params_t *)fb->internal;
+    CHECK(led_effect_begin(fb, &params->clock));
+
+    // parameters published since the previous frame
+    uint8_t p[LED_EFFECT_MAX_PARAMS];
+    if (led_effect_params_take(&params->pending, p))
+        CHECK(apply_params(fb, p));
+
+    params->hue += params->speed * params->clock.steps;
 
     if (params->direction == RAINBOW_DIAGONAL)
     {
@@ -71,7 +97,7 @@ esp_err_t led_effect_rainbow_run(framebuffer_t *fb)
             {
                 float twirl = 3.0f * params->scale / 100.0f;
                 hsv_t color = {
-                    .hue = fb->frame_num * params->speed * 2 + (fb->width / fb->height * x + y * twirl) * params->scale,
+                    .hue = params->hue * 2 + (fb->width / fb->height * x + y * twirl) * params->scale,
                     .sat = 255,
                     .val = 255
                 };
@@ -86,7 +112,7 @@ esp_err_t led_effect_rainbow_run(framebuffer_t *fb)
         for (size_t i = 0; i < outer; i++)
         {
             hsv_t color = {
-                .hue = fb->frame_num * params->speed + i * params->scale,
+                .hue = params->hue + i * params->scale,
                 .sat = 255,
                 .val = 255
             };
@@ -100,3 +126,25 @@ esp_err_t led_effect_rainbow_run(framebuffer_t *fb)
 
     return fb_end(fb);
 }
+
+static esp_err_t rainbow_update_params(framebuffer_t *fb, const uint8_t *p)
+{
+    return led_effect_rainbow_set_params(fb, p[0], p[1], p[2]);
+}
+
+static esp_err_t rainbow_init_params(framebuffer_t *fb, const uint8_t *p)
+{
+    return led_effect_rainbow_init(fb, p[0], p[1], p[2]);
+}
+
+const led_effect_t led_effect_rainbow = {
+    .name = "Rainbow",
+    .init = rainbow_init_params,
+    .run = led_effect_rainbow_run,
+    .done = led_effect_rainbow_done,
+    .set_params = rainbow_update_params,
+    .num_params = 3,
+    .params = { { 0, 2 }, { 10, 49 }, { 1, 19 } },
+    .state_size = sizeof(params_t),
+    .cycles_per_pixel = 80,
+};
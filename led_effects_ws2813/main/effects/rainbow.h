@@ -15,6 +15,8 @@
 
 #include <framebuffer.h>
 
+#include "effects/effect.h"
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -25,6 +27,8 @@ typedef enum {
     RAINBOW_DIAGONAL,
 } led_effect_rainbow_direction_t;
 
+extern const led_effect_t led_effect_rainbow;
+
 esp_err_t led_effect_rainbow_init(framebuffer_t *fb, led_effect_rainbow_direction_t direction,
         uint8_t scale, uint8_t speed);
 
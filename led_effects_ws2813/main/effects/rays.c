@@ -29,17 +29,25 @@ typedef struct
     uint8_t max_rays;
     uint8_t hue;
     uint8_t num_rays;
+    led_effect_clock_t clock;
+    led_effect_params_t pending;
+    led_effect_rng_t rng;
 } params_t;
 
+LED_EFFECT_CHECK_STATE(sizeof(params_t), 0);
+
 esp_err_t led_effect_rays_init(framebuffer_t *fb, uint8_t speed, uint8_t min_rays, uint8_t max_rays)
 {
     CHECK_ARG(fb);
 
     // allocate internal storage
-    fb->internal = calloc(1, sizeof(params_t));
+    fb->internal = led_effect_alloc(fb, sizeof(params_t));
     if (!fb->internal)
         return ESP_ERR_NO_MEM;
 
+    // seed random stream
+    led_effect_rng_init(&((params_t *)fb->internal)->rng);
+
     return led_effect_rays_set_params(fb, speed, min_rays, max_rays);
 }
 
@@ -49,14 +57,17 @@ esp_err_t led_effect_rays_done(framebuffer_t *fb)
 
     // free internal storage
     if (fb->internal)
-        free(fb->internal);
+        led_effect_free(fb, fb->internal);
 
     return ESP_OK;
 }
 
-esp_err_t led_effect_rays_set_params(framebuffer_t *fb, uint8_t speed, uint8_t min_rays, uint8_t max_rays)
+// applies published parameters, render side only
+static esp_err_t apply_params(framebuffer_t *fb, const uint8_t *p)
 {
-    CHECK_ARG(fb && fb->internal);
+    uint8_t speed = p[0];
+    uint8_t min_rays = p[1];
+    uint8_t max_rays = p[2];
 
     params_t *params = (params_t *)fb->internal;
     params->speed = speed;
@@ -66,6 +77,16 @@ esp_err_t led_effect_rays_set_params(framebuffer_t *fb, uint8_t speed, uint8_t m
     return ESP_OK;
 }
 
+esp_err_t led_effect_rays_set_params(framebuffer_t *fb, uint8_t speed, uint8_t min_rays, uint8_t max_rays)
+{
+    CHECK_ARG(fb && fb->internal);
+
+    uint8_t p[LED_EFFECT_MAX_PARAMS] = { speed, min_rays, max_rays };
+    led_effect_params_publish(&((params_t *)fb->internal)->pending, p);
+
+    return ESP_OK;
+}
+
 static void line(framebuffer_t *fb, uint8_t x1, uint8_t y1, uint8_t x2, uint8_t y2, rgb_t color)
 {
     uint8_t xsteps = abs8(x1 - x2) + 1;
@@ -85,14 +106,20 @@ static void line(framebuffer_t *fb, uint8_t x1, uint8_t y1, uint8_t x2, uint8_t
 
 esp_err_t led_effect_rays_run(framebuffer_t *fb)
 {
-    CHECK(fb_begin(fb));
+    CHECK_ARG(fb && fb->internal);
 
     params_t *params = (params_t *)fb->internal;
+    CHECK(led_effect_begin(fb, &params->clock));
+
+    // parameters published since the previous frame
+    uint8_t p[LED_EFFECT_MAX_PARAMS];
+    if (led_effect_params_take(&params->pending, p))
+        CHECK(apply_params(fb, p));
 
     // change number of rays
-    if (params->max_rays > params->min_rays && !(fb->frame_num % 10))
+    if (params->max_rays > params->min_rays && led_effect_every(&params->clock, 10))
     {
-        if (random8_to(2))
+        if (led_effect_random8_to(&params->rng, 2))
             params->num_rays++;
         else
             params->num_rays--;
@@ -102,14 +129,15 @@ esp_err_t led_effect_rays_run(framebuffer_t *fb)
             params->num_rays = params->max_rays;
     }
 
-    params->hue += 5;
-    fb_fade(fb, 40);
+    params->hue = params->clock.frames * 5;
+    for (uint32_t i = 0; i < params->clock.steps; i++)
+        fb_fade(fb, 40);
     for (uint8_t i = 0; i < params->num_rays; i++)
     {
-        uint8_t x1 = beatsin8(4 + params->speed, 0, (fb->width - 1), 0, 0);
-        uint8_t x2 = beatsin8(2 + params->speed, 0, (fb->width - 1), 0, 0);
-        uint8_t y1 = beatsin8(8 + params->speed, 0, (fb->height - 1), 0, i * 24);
-        uint8_t y2 = beatsin8(10 + params->speed, 0, (fb->height - 1), 0, i * 48 + 64);
+        uint8_t x1 = led_effect_beatsin8(&params->clock, 4 + params->speed, 0, (fb->width - 1), 0);
+        uint8_t x2 = led_effect_beatsin8(&params->clock, 2 + params->speed, 0, (fb->width - 1), 0);
+        uint8_t y1 = led_effect_beatsin8(&params->clock, 8 + params->speed, 0, (fb->height - 1), i * 24);
+        uint8_t y2 = led_effect_beatsin8(&params->clock, 10 + params->speed, 0, (fb->height - 1), i * 48 + 64);
 
         line(fb, x1, x2, y1, y2, hsv2rgb_rainbow(hsv_from_values(i * 255 / params->num_rays + params->hue, 255, 255)));
     }
@@ -117,3 +145,25 @@ esp_err_t led_effect_rays_run(framebuffer_t *fb)
 
     return fb_end(fb);
 }
+
+static esp_err_t rays_update_params(framebuffer_t *fb, const uint8_t *p)
+{
+    return led_effect_rays_set_params(fb, p[0], p[1], p[2]);
+}
+
+static esp_err_t rays_init_params(framebuffer_t *fb, const uint8_t *p)
+{
+    return led_effect_rays_init(fb, p[0], p[1], p[2]);
+}
+
+const led_effect_t led_effect_rays = {
+    .name = "Rays",
+    .init = rays_init_params,
+    .run = led_effect_rays_run,
+    .done = led_effect_rays_done,
+    .set_params = rays_update_params,
+    .num_params = 3,
+    .params = { { 0, 49 }, { 3, 4 }, { 5, 9 } },
+    .state_size = sizeof(params_t),
+    .cycles_per_pixel = 60,
+};
@@ -19,10 +19,14 @@
 
 #include <framebuffer.h>
 
+#include "effects/effect.h"
+
 #ifdef __cplusplus
 extern "C" {
 #endif
 
+extern const led_effect_t led_effect_rays;
+
 esp_err_t led_effect_rays_init(framebuffer_t *fb, uint8_t speed, uint8_t min_rays, uint8_t max_rays);
 
 esp_err_t led_effect_rays_done(framebuffer_t *fb);
@@ -16,17 +16,25 @@ typedef struct
 {
     uint8_t max_sparkles;
     uint8_t fadeout_speed;
+    led_effect_clock_t clock;
+    led_effect_params_t pending;
+    led_effect_rng_t rng;
 } params_t;
 
+LED_EFFECT_CHECK_STATE(sizeof(params_t), 0);
+
 esp_err_t led_effect_sparkles_init(framebuffer_t *fb, uint8_t max_sparkles, uint8_t fadeout_speed)
 {
     CHECK_ARG(fb);
 
     // allocate internal storage
-    fb->internal = calloc(1, sizeof(params_t));
+    fb->internal = led_effect_alloc(fb, sizeof(params_t));
     if (!fb->internal)
         return ESP_ERR_NO_MEM;
 
+    // seed random stream
+    led_effect_rng_init(&((params_t *)fb->internal)->rng);
+
     return led_effect_sparkles_set_params(fb, max_sparkles, fadeout_speed);
 }
 
@@ -36,14 +44,16 @@ esp_err_t led_effect_sparkles_done(framebuffer_t *fb)
 
     // free internal storage
     if (fb->internal)
-        free(fb->internal);
+        led_effect_free(fb, fb->internal);
 
     return ESP_OK;
 }
 
-esp_err_t led_effect_sparkles_set_params(framebuffer_t *fb, uint8_t max_sparkles, uint8_t fadeout_speed)
+// applies published parameters, render side only
+static esp_err_t apply_params(framebuffer_t *fb, const uint8_t *p)
 {
-    CHECK_ARG(fb && fb->internal);
+    uint8_t max_sparkles = p[0];
+    uint8_t fadeout_speed = p[1];
 
     params_t *params = (params_t *)fb->internal;
     params->max_sparkles = max_sparkles;
@@ -52,24 +62,69 @@ esp_err_t led_effect_sparkles_set_params(framebuffer_t *fb, uint8_t max_sparkles
     return ESP_OK;
 }
 
-esp_err_t led_effect_sparkles_run(framebuffer_t *fb)
+esp_err_t led_effect_sparkles_set_params(framebuffer_t *fb, uint8_t max_sparkles, uint8_t fadeout_speed)
 {
-    CHECK(fb_begin(fb));
+    CHECK_ARG(fb && fb->internal);
 
-    params_t *params = (params_t *)fb->internal;
+    uint8_t p[LED_EFFECT_MAX_PARAMS] = { max_sparkles, fadeout_speed };
+    led_effect_params_publish(&((params_t *)fb->internal)->pending, p);
+
+    return ESP_OK;
+}
 
+// single step of simulation at reference frame rate
+static void step(framebuffer_t *fb, params_t *params)
+{
     fb_blur2d(fb, 8);
     for (uint8_t i = 0; i < params->max_sparkles; i++)
     {
-        uint16_t x = random16_to(fb->width);
-        uint16_t y = random16_to(fb->height);
+        uint16_t x = led_effect_random16_to(&params->rng, fb->width);
+        uint16_t y = led_effect_random16_to(&params->rng, fb->height);
 
         rgb_t c;
         fb_get_pixel_rgb(fb, x, y, &c);
         if (rgb_luma(c) < 5)
-            fb_set_pixel_hsv(fb, x, y, hsv_from_values(random8(), 255, 255));
+            fb_set_pixel_hsv(fb, x, y, hsv_from_values(led_effect_random8(&params->rng), 255, 255));
     }
     fb_fade(fb, params->fadeout_speed);
+}
+
+esp_err_t led_effect_sparkles_run(framebuffer_t *fb)
+{
+    CHECK_ARG(fb && fb->internal);
+
+    params_t *params = (params_t *)fb->internal;
+    CHECK(led_effect_begin(fb, &params->clock));
+
+    // parameters published since the previous frame
+    uint8_t p[LED_EFFECT_MAX_PARAMS];
+    if (led_effect_params_take(&params->pending, p))
+        CHECK(apply_params(fb, p));
+
+    for (uint32_t i = 0; i < params->clock.steps; i++)
+        step(fb, params);
 
     return fb_end(fb);
 }
+
+static esp_err_t sparkles_update_params(framebuffer_t *fb, const uint8_t *p)
+{
+    return led_effect_sparkles_set_params(fb, p[0], p[1]);
+}
+
+static esp_err_t sparkles_init_params(framebuffer_t *fb, const uint8_t *p)
+{
+    return led_effect_sparkles_init(fb, p[0], p[1]);
+}
+
+const led_effect_t led_effect_sparkles = {
+    .name = "Sparkles",
+    .init = sparkles_init_params,
+    .run = led_effect_sparkles_run,
+    .done = led_effect_sparkles_done,
+    .set_params = sparkles_update_params,
+    .num_params = 2,
+    .params = { { 1, 19 }, { 10, 149 } },
+    .state_size = sizeof(params_t),
+    .cycles_per_pixel = 30,
+};
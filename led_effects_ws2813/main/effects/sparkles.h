@@ -12,10 +12,14 @@
 
 #include <framebuffer.h>
 
+#include "effects/effect.h"
+
 #ifdef __cplusplus
 extern "C" {
 #endif
 
+extern const led_effect_t led_effect_sparkles;
+
 esp_err_t led_effect_sparkles_init(framebuffer_t *fb, uint8_t max_sparkles, uint8_t fadeout_speed);
 
 esp_err_t led_effect_sparkles_done(framebuffer_t *fb);
@@ -0,0 +1,183 @@
+/**
+ * @file tiles.c
+ *
+ * Rendering frames of per-pixel effects on several cores
+ */
+#include <string.h>
+
+#ifdef ESP_PLATFORM
+#include <freertos/FreeRTOS.h>
+#include <esp_pthread.h>
+#endif
+
+#include "effects/tiles.h"
+
+#define CHECK(x) do { esp_err_t __; if ((__ = x) != ESP_OK) return __; } while (0)
+#define CHECK_ARG(VAL) do { if (!(VAL)) return ESP_ERR_INVALID_ARG; } while (0)
+
+static led_effect_tiles_t *active_tiles = NULL;
+
+static void render_band(led_effect_tiles_t *tiles, size_t band)
+{
+    size_t rows = tiles->y1 - tiles->y0;
+    size_t y0 = tiles->y0 + rows * band / tiles->num_workers;
+    size_t y1 = tiles->y0 + rows * (band + 1) / tiles->num_workers;
+    if (y0 == y1)
+        return;
+
+    esp_err_t res = tiles->effect->rows(tiles->fb, y0, y1);
+    if (res != ESP_OK)
+    {
+        pthread_mutex_lock(&tiles->lock);
+        tiles->result = res;
+        pthread_mutex_unlock(&tiles->lock);
+    }
+}
+
+static void *worker(void *arg)
+{
+    led_effect_worker_t *w = (led_effect_worker_t *)arg;
+    led_effect_tiles_t *tiles = w->tiles;
+    uint32_t frame = 0;
+
+    pthread_mutex_lock(&tiles->lock);
+    while (true)
+    {
+        while (tiles->frame == frame && !tiles->stop)
+            pthread_cond_wait(&tiles->start, &tiles->lock);
+        if (tiles->stop)
+            break;
+        frame = tiles->frame;
+        pthread_mutex_unlock(&tiles->lock);
+
+        render_band(tiles, w->num);
+
+        // the last one wakes up caller
+        pthread_mutex_lock(&tiles->lock);
+        if (!--tiles->pending)
+            pthread_cond_signal(&tiles->done);
+    }
+    pthread_mutex_unlock(&tiles->lock);
+
+    return NULL;
+}
+
+static esp_err_t start_worker(led_effect_tiles_t *tiles, size_t num)
+{
+    led_effect_worker_t *w = &tiles->workers[num];
+    w->tiles = tiles;
+    w->num = num;
+
+#ifdef ESP_PLATFORM
+    esp_pthread_cfg_t cfg = esp_pthread_get_default_config();
+    cfg.stack_size = LED_EFFECT_WORKER_STACK;
+    cfg.prio = LED_EFFECT_WORKER_PRIO;
+    cfg.pin_to_core = num % portNUM_PROCESSORS;
+    cfg.thread_name = "tiles";
+    CHECK(esp_pthread_set_cfg(&cfg));
+#endif
+
+    return pthread_create(&w->thread, NULL, worker, w) ? ESP_ERR_NO_MEM : ESP_OK;
+}
+
+esp_err_t led_effect_tiles_init(led_effect_tiles_t *tiles, size_t num_workers)
+{
+    CHECK_ARG(tiles && num_workers && num_workers <= LED_EFFECT_MAX_WORKERS);
+
+    memset(tiles, 0, sizeof(led_effect_tiles_t));
+    if (pthread_mutex_init(&tiles->lock, NULL))
+        return ESP_ERR_NO_MEM;
+    if (pthread_cond_init(&tiles->start, NULL) || pthread_cond_init(&tiles->done, NULL))
+    {
+        pthread_mutex_destroy(&tiles->lock);
+        return ESP_ERR_NO_MEM;
+    }
+
+    for (size_t i = 0; i < num_workers; i++)
+    {
+        esp_err_t res = start_worker(tiles, i);
+        if (res != ESP_OK)
+        {
+            led_effect_tiles_free(tiles);
+            return res;
+        }
+        tiles->num_workers++;
+    }
+
+    return ESP_OK;
+}
+
+esp_err_t led_effect_tiles_free(led_effect_tiles_t *tiles)
+{
+    CHECK_ARG(tiles);
+
+    if (active_tiles == tiles)
+        active_tiles = NULL;
+
+    pthread_mutex_lock(&tiles->lock);
+    tiles->stop = true;
+    pthread_cond_broadcast(&tiles->start);
+    pthread_mutex_unlock(&tiles->lock);
+
+    for (size_t i = 0; i < tiles->num_workers; i++)
+        pthread_join(tiles->workers[i].thread, NULL);
+    tiles->num_workers = 0;
+
+    pthread_cond_destroy(&tiles->start);
+    pthread_cond_destroy(&tiles->done);
+    pthread_mutex_destroy(&tiles->lock);
+
+    return ESP_OK;
+}
+
+void led_effect_set_tiles(led_effect_tiles_t *tiles)
+{
+    active_tiles = tiles;
+}
+
+esp_err_t led_effect_render_rows(framebuffer_t *fb, const led_effect_t *effect)
+{
+    CHECK_ARG(fb);
+
+    return led_effect_render_row_range(fb, effect, 0, fb->height);
+}
+
+esp_err_t led_effect_render_row_range(framebuffer_t *fb, const led_effect_t *effect, size_t y0, size_t y1)
+{
+    CHECK_ARG(fb && effect && effect->rows && y0 <= y1 && y1 <= fb->height);
+
+    led_effect_tiles_t *tiles = active_tiles;
+    if (!tiles)
+        return effect->rows(fb, y0, y1);
+
+    // every worker renders its band of the rows
+    pthread_mutex_lock(&tiles->lock);
+    tiles->effect = effect;
+    tiles->fb = fb;
+    tiles->y0 = y0;
+    tiles->y1 = y1;
+    tiles->result = ESP_OK;
+    tiles->pending = tiles->num_workers;
+    tiles->frame++;
+    pthread_cond_broadcast(&tiles->start);
+
+    // barrier, frame is complete when all bands are
+    while (tiles->pending)
+        pthread_cond_wait(&tiles->done, &tiles->lock);
+    esp_err_t res = tiles->result;
+    pthread_mutex_unlock(&tiles->lock);
+
+    return res;
+}
+
+esp_err_t led_effect_render(framebuffer_t *fb, const led_effect_t *effect)
+{
+    CHECK_ARG(fb && effect && effect->begin && effect->rows);
+
+    CHECK(effect->begin(fb));
+    // framebuffer is released on errors too
+    esp_err_t res = led_effect_render_rows(fb, effect);
+    esp_err_t end = fb_end(fb);
+
+    return res != ESP_OK ? res : end;
+}
@@ -0,0 +1,134 @@
+/**
+ * @file tiles.h
+ *
+ * @defgroup led_effect_tiles led_effect_tiles
+ * @{
+ *
+ * Rendering frames of per-pixel effects on several cores
+ *
+ * Effects with `begin` and `rows` entry points are rendered by
+ * led_effect_render(). Without workers the whole frame is rendered by the
+ * caller. With workers set by led_effect_set_tiles() the frame is started
+ * by the caller, split into bands of rows, one per worker, and the caller
+ * waits until all bands are done before fb_end().
+ *
+ * Workers are POSIX threads sleeping between frames. On ESP32 worker `n`
+ * is pinned to core `n % portNUM_PROCESSORS`; elsewhere they are not
+ * pinned, so rendering can be checked on a host too.
+ */
+#ifndef __LED_EFFECTS_TILES_H__
+#define __LED_EFFECTS_TILES_H__
+
+#include <pthread.h>
+#include <framebuffer.h>
+
+#include "effects/effect.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define LED_EFFECT_MAX_WORKERS  4    ///< Max number of workers
+#define LED_EFFECT_WORKER_STACK 4096 ///< Stack size of a worker, bytes
+#define LED_EFFECT_WORKER_PRIO  20   ///< FreeRTOS priority of workers, below esp_timer task
+
+struct led_effect_tiles_s;
+
+/**
+ * Worker thread
+ */
+typedef struct
+{
+    struct led_effect_tiles_s *tiles; ///< Workers it belongs to
+    size_t num;                       ///< Worker number, band of rows it renders
+    pthread_t thread;                 ///< Thread
+} led_effect_worker_t;
+
+/**
+ * Workers rendering bands of rows
+ */
+typedef struct led_effect_tiles_s
+{
+    size_t num_workers;                                 ///< Number of workers
+    led_effect_worker_t workers[LED_EFFECT_MAX_WORKERS]; ///< Workers
+    pthread_mutex_t lock;                               ///< Guards everything below
+    pthread_cond_t start;                               ///< New frame or stop
+    pthread_cond_t done;                                ///< All bands rendered
+    uint32_t frame;                                     ///< Frames started
+    size_t pending;                                     ///< Workers still rendering the frame
+    bool stop;                                          ///< Workers exit
+    const led_effect_t *effect;                         ///< Effect of the current frame
+    framebuffer_t *fb;                                  ///< Framebuffer of the current frame
+    size_t y0;                                          ///< First row to render
+    size_t y1;                                          ///< Row after the last one to render
+    esp_err_t result;                                   ///< Error of any band of the frame
+} led_effect_tiles_t;
+
+/**
+ * @brief Start workers
+ *
+ * @param tiles Workers descriptor
+ * @param num_workers Number of workers, 1..LED_EFFECT_MAX_WORKERS
+ * @return `ESP_OK` on success
+ */
+esp_err_t led_effect_tiles_init(led_effect_tiles_t *tiles, size_t num_workers);
+
+/**
+ * @brief Stop workers and free resources
+ *
+ * @param tiles Workers descriptor
+ * @return `ESP_OK` on success
+ */
+esp_err_t led_effect_tiles_free(led_effect_tiles_t *tiles);
+
+/**
+ * @brief Set workers rendering effects
+ *
+ * Frames are rendered by a single caller at a time.
+ *
+ * @param tiles Workers descriptor, NULL to render in the calling task
+ */
+void led_effect_set_tiles(led_effect_tiles_t *tiles);
+
+/**
+ * @brief Render all rows of frame started by `begin` of effect
+ *
+ * On all workers if they are set. Doesn't call fb_end().
+ *
+ * @param fb Framebuffer
+ * @param effect Effect descriptor
+ * @return `ESP_OK` on success
+ */
+esp_err_t led_effect_render_rows(framebuffer_t *fb, const led_effect_t *effect);
+
+/**
+ * @brief Render rows `y0..y1 - 1` of frame started by `begin` of effect
+ *
+ * Same as led_effect_render_rows(), the rows are split between workers.
+ *
+ * @param fb Framebuffer
+ * @param effect Effect descriptor
+ * @param y0 First row
+ * @param y1 Row after the last one, up to framebuffer height
+ * @return `ESP_OK` on success
+ */
+esp_err_t led_effect_render_row_range(framebuffer_t *fb, const led_effect_t *effect, size_t y0, size_t y1);
+
+/**
+ * @brief Render frame of effect from its `begin` and `rows`
+ *
+ * Effects with `begin` and `rows` use it as their `run`.
+ *
+ * @param fb Framebuffer
+ * @param effect Effect descriptor
+ * @return `ESP_OK` on success
+ */
+esp_err_t led_effect_render(framebuffer_t *fb, const led_effect_t *effect);
+
+#ifdef __cplusplus
+}
+#endif
+
+/**@}*/
+
+#endif /* __LED_EFFECTS_TILES_H__ */
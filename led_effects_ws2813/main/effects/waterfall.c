@@ -29,21 +29,29 @@ typedef struct
     uint8_t sparking;
     rgb_t palette[PALETTE_SIZE];
     uint8_t *map;
+    led_effect_clock_t clock;
+    led_effect_params_t pending;
+    led_effect_rng_t rng;
 } params_t;
 
+LED_EFFECT_CHECK_STATE(sizeof(params_t), 1);
+
 esp_err_t led_effect_waterfall_init(framebuffer_t *fb, led_effect_waterfall_mode_t mode,
         uint8_t hue, uint8_t cooling, uint8_t sparking)
 {
     CHECK_ARG(fb);
 
     // allocate internal storage
-    fb->internal = calloc(1, sizeof(params_t));
+    fb->internal = led_effect_alloc(fb, sizeof(params_t));
     if (!fb->internal)
         return ESP_ERR_NO_MEM;
 
+    // seed random stream
+    led_effect_rng_init(&((params_t *)fb->internal)->rng);
+
     // allocate color map
     params_t *params = (params_t *)fb->internal;
-    params->map = calloc(fb->width * fb->height, 1);
+    params->map = led_effect_alloc(fb, fb->width * fb->height);
     if (!params->map)
         return ESP_ERR_NO_MEM;
 
@@ -57,19 +65,22 @@ esp_err_t led_effect_waterfall_done(framebuffer_t *fb)
 
     // free map
     if (params && params->map)
-        free(params->map);
+        led_effect_free(fb, params->map);
 
     // free internal storage
     if (fb->internal)
-        free(fb->internal);
+        led_effect_free(fb, fb->internal);
 
     return ESP_OK;
 }
 
-esp_err_t led_effect_waterfall_set_params(framebuffer_t *fb, led_effect_waterfall_mode_t mode,
-        uint8_t hue, uint8_t cooling, uint8_t sparking)
+// applies published parameters, render side only
+static esp_err_t apply_params(framebuffer_t *fb, const uint8_t *p)
 {
-    CHECK_ARG(fb && fb->internal);
+    led_effect_waterfall_mode_t mode = p[0];
+    uint8_t hue = p[1];
+    uint8_t cooling = p[2];
+    uint8_t sparking = p[3];
 
     params_t *params = (params_t *)fb->internal;
     params->mode = mode;
@@ -115,32 +126,62 @@ esp_err_t led_effect_waterfall_set_params(framebuffer_t *fb, led_effect_waterfal
     return ESP_OK;
 }
 
+esp_err_t led_effect_waterfall_set_params(framebuffer_t *fb, led_effect_waterfall_mode_t mode,
+        uint8_t hue, uint8_t cooling, uint8_t sparking)
+{
+    CHECK_ARG(fb && fb->internal);
+    if (mode > WATERFALL_COLD_FIRE)
+        return ESP_ERR_NOT_SUPPORTED;
+
+    uint8_t p[LED_EFFECT_MAX_PARAMS] = { mode, hue, cooling, sparking };
+    led_effect_params_publish(&((params_t *)fb->internal)->pending, p);
+
+    return ESP_OK;
+}
+
 #define MAP_XY(x, y) ((y) * fb->width + (x))
 
 esp_err_t led_effect_waterfall_run(framebuffer_t *fb)
 {
-    CHECK(fb_begin(fb));
+    CHECK_ARG(fb && fb->internal);
 
     params_t *params = (params_t *)fb->internal;
+    CHECK(led_effect_begin(fb, &params->clock));
+
+    // parameters published since the previous frame
+    uint8_t p[LED_EFFECT_MAX_PARAMS];
+    if (led_effect_params_take(&params->pending, p))
+        CHECK(apply_params(fb, p));
+
+    // random cooling limit doesn't change within frame
+    uint8_t cooling = (params->cooling * 10 / fb->height) + 2;
 
     for (size_t x = 0; x < fb->width; x++)
     {
         size_t y;
 
-        // Step 1.  Cool down every cell a little
-        for (y = 0; y < fb->height; y++)
-            params->map[MAP_XY(x, y)] = qsub8(params->map[MAP_XY(x, y)], random8_to((params->cooling * 10 / fb->height) + 2));
-
-        // Step 2.  Heat from each cell drifts 'up' and diffuses a little
-        for (y = fb->height - 1; y >= 2; y--)
-            params->map[MAP_XY(x, y)] =
-                    (params->map[MAP_XY(x, y - 1)] + params->map[MAP_XY(x, y - 2)] + params->map[MAP_XY(x, y - 2)]) / 3;
-
-        // Step 3.  Randomly ignite new 'sparks' of heat near the bottom
-        if (random8() < params->sparking)
+        // Steps 1-3 simulate heat once per reference frame
+        for (uint32_t s = 0; s < params->clock.steps; s++)
         {
-            y = random8_to(2);
-            params->map[MAP_XY(x, y)] = qadd8(params->map[MAP_XY(x, y)], random8_between(160, 255));
+            // Step 1.  Cool down every cell a little, four cells per random word
+            for (y = 0; y < fb->height; y += 4)
+            {
+                uint32_t cool = led_effect_random8x4_to(&params->rng, cooling);
+                for (size_t i = y; i < y + 4 && i < fb->height; i++, cool >>= 8)
+                    params->map[MAP_XY(x, i)] = qsub8(params->map[MAP_XY(x, i)], cool & 0xff);
+            }
+
+            // Step 2.  Heat from each cell drifts 'up' and diffuses a little
+            for (y = fb->height - 1; y >= 2; y--)
+                params->map[MAP_XY(x, y)] =
+                        (params->map[MAP_XY(x, y - 1)] + params->map[MAP_XY(x, y - 2)] + params->map[MAP_XY(x, y - 2)]) / 3;
+
+            // Step 3.  Randomly ignite new 'sparks' of heat near the bottom
+            if (led_effect_random8(&params->rng) < params->sparking)
+            {
+                y = led_effect_random8_to(&params->rng, 2);
+                params->map[MAP_XY(x, y)] = qadd8(params->map[MAP_XY(x, y)], led_effect_random8_between(&params->rng, 160, 255));
+            }
         }
 
         // Step 4.  Map from heat cells to LED colors
@@ -157,3 +198,40 @@ esp_err_t led_effect_waterfall_run(framebuffer_t *fb)
 
     return fb_end(fb);
 }
+
+// both descriptors differ only in ranges of the mode parameter
+static esp_err_t waterfall_init_params(framebuffer_t *fb, const uint8_t *p)
+{
+    return led_effect_waterfall_init(fb, p[0], p[1], p[2], p[3]);
+}
+
+static esp_err_t waterfall_update_params(framebuffer_t *fb, const uint8_t *p)
+{
+    return led_effect_waterfall_set_params(fb, p[0], p[1], p[2], p[3]);
+}
+
+const led_effect_t led_effect_waterfall_fire = {
+    .name = "Waterfall fire",
+    .init = waterfall_init_params,
+    .run = led_effect_waterfall_run,
+    .done = led_effect_waterfall_done,
+    .set_params = waterfall_update_params,
+    .num_params = 4,
+    .params = { { 2, 3 }, { 0, 0 }, { 20, 119 }, { 50, 199 } },
+    .state_size = sizeof(params_t),
+    .state_per_pixel = 1,
+    .cycles_per_pixel = 80,
+};
+
+const led_effect_t led_effect_waterfall = {
+    .name = "Waterfall",
+    .init = waterfall_init_params,
+    .run = led_effect_waterfall_run,
+    .done = led_effect_waterfall_done,
+    .set_params = waterfall_update_params,
+    .num_params = 4,
+    .params = { { 0, 1 }, { 1, 254 }, { 20, 119 }, { 50, 199 } },
+    .state_size = sizeof(params_t),
+    .state_per_pixel = 1,
+    .cycles_per_pixel = 80,
+};
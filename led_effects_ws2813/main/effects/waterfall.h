@@ -19,6 +19,8 @@
 
 #include <framebuffer.h>
 
+#include "effects/effect.h"
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -30,6 +32,10 @@ typedef enum {
     WATERFALL_COLD_FIRE,
 } led_effect_waterfall_mode_t;
 
+extern const led_effect_t led_effect_waterfall_fire;
+
+extern const led_effect_t led_effect_waterfall;
+
 esp_err_t led_effect_waterfall_init(framebuffer_t *fb, led_effect_waterfall_mode_t mode,
         uint8_t hue, uint8_t cooling, uint8_t sparking);
 
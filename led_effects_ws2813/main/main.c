@@ -1,211 +1,762 @@
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 #include <freertos/FreeRTOS.h>
 #include <freertos/task.h>
 #include <esp_log.h>
+#include <esp_timer.h>
 
-#include <led_strip.h>
 #include <lib8tion.h>
 #include <framebuffer.h>
-#include <fbanimation.h>
-
-#include <effects/noise.h>
-#include <effects/plasma_waves.h>
-#include <effects/rainbow.h>
-#include <effects/waterfall.h>
-#include <effects/dna.h>
-#include <effects/rays.h>
-#include <effects/crazybees.h>
-#include <effects/sparkles.h>
-#include <effects/matrix.h>
-#include <effects/rain.h>
-#include <effects/fire.h>
+
+#ifdef CONFIG_EXAMPLE_OUTPUT_BENCHMARK
+#include <led_strip.h>
+#include <esp_cpu.h>
+#endif
+
+#ifdef CONFIG_EXAMPLE_OUTPUT_BACKEND_MOCK
+#include <esp_idf_version.h>
+#include <esp_vfs_semihost.h>
+#endif
+
+#include <output/output.h>
+#include <output/backends.h>
+
+#include <effects/effect.h>
+#include <effects/tiles.h>
+#include <effects/bench.h>
+#include <player/player.h>
+#include <player/scheduler.h>
+#include <player/blend.h>
 
 static const char *TAG = "led_effect_example";
 
 #define LED_GPIO CONFIG_EXAMPLE_LED_GPIO
 #define LED_TYPE LED_STRIP_WS2812
+#define LED_LANES CONFIG_EXAMPLE_LED_LANES
+
+#if defined(CONFIG_EXAMPLE_OUTPUT_BACKEND_MOCK)
+#define OUTPUT_BACKEND output_backend_mock
+#elif defined(CONFIG_EXAMPLE_OUTPUT_BACKEND_SPI)
+#define OUTPUT_BACKEND output_backend_spi
+#else
+#define OUTPUT_BACKEND output_backend_rmt
+#endif
 
 #define LED_MATRIX_WIDTH  CONFIG_EXAMPLE_LED_MATRIX_WIDTH
 #define LED_MATRIX_HEIGHT CONFIG_EXAMPLE_LED_MATRIX_HEIGHT
 #define LED_BRIGHTNESS CONFIG_EXAMPLE_LED_BRIGHTNESS // 0..255
+#define LED_GAMMA (CONFIG_EXAMPLE_LED_GAMMA / 100.0f)
+#define LED_WHITE_R CONFIG_EXAMPLE_LED_WHITE_R
+#define LED_WHITE_G CONFIG_EXAMPLE_LED_WHITE_G
+#define LED_WHITE_B CONFIG_EXAMPLE_LED_WHITE_B
+#define LED_MAX_CURRENT CONFIG_EXAMPLE_LED_MAX_CURRENT         // mA
+#define LED_CHANNEL_CURRENT CONFIG_EXAMPLE_LED_CHANNEL_CURRENT // uA
+#define LED_IDLE_CURRENT CONFIG_EXAMPLE_LED_IDLE_CURRENT       // uA
+
+#define PANEL_WIDTH  CONFIG_EXAMPLE_LED_PANEL_WIDTH
+#define PANEL_HEIGHT CONFIG_EXAMPLE_LED_PANEL_HEIGHT
+#define PANEL_COLS   (LED_MATRIX_WIDTH / PANEL_WIDTH)
+#define PANEL_ROWS   (LED_MATRIX_HEIGHT / PANEL_HEIGHT)
+
+#if LED_MATRIX_WIDTH % PANEL_WIDTH || LED_MATRIX_HEIGHT % PANEL_HEIGHT
+#error "LED matrix must consist of whole panels"
+#endif
+
+// matrix is split into zones of equal blocks of panel rows, each on its own lanes
+#define ZONES           CONFIG_EXAMPLE_ZONES
+#define ZONE_WIDTH      LED_MATRIX_WIDTH
+#define ZONE_HEIGHT     (LED_MATRIX_HEIGHT / ZONES)
+#define ZONE_PANEL_ROWS (PANEL_ROWS / ZONES)
+#define ZONE_LANES      (LED_LANES / ZONES)
+
+#if PANEL_ROWS % ZONES || LED_LANES % ZONES
+#error "Rows of panels and lanes must be split between zones evenly"
+#endif
+
+#ifdef CONFIG_EXAMPLE_LED_PANEL_WIRING_PROGRESSIVE
+#define PANEL_WIRING LAYOUT_WIRING_PROGRESSIVE
+#else
+#define PANEL_WIRING LAYOUT_WIRING_SERPENTINE
+#endif
+
+#ifdef CONFIG_EXAMPLE_LED_PANEL_CHAIN_SERPENTINE
+#define PANEL_CHAIN_SERPENTINE true
+#else
+#define PANEL_CHAIN_SERPENTINE false
+#endif
 
 #define FPS CONFIG_EXAMPLE_FPS
+#define MIN_FPS CONFIG_EXAMPLE_MIN_FPS
 
 #define SWITCH_PERIOD_MS CONFIG_EXAMPLE_SWITCH_PERIOD_MS
+#define TRANSITION_MS CONFIG_EXAMPLE_TRANSITION_MS
+
+#if TRANSITION_MS >= SWITCH_PERIOD_MS
+#error "Crossfade must be shorter than effect switch period"
+#endif
+
+// CPU cycles per second available for rendering effects of a zone
+#define EFFECT_CPU_HZ (CONFIG_ESP32_DEFAULT_CPU_FREQ_MHZ * 1000000 / ZONES)
+
+
+#ifdef CONFIG_EXAMPLE_EFFECT_TILES
+static led_effect_tiles_t tiles;
+#endif
 
-#define CHECK(x) do { esp_err_t __; if ((__ = x) != ESP_OK) return __; } while (0)
+#ifdef CONFIG_EXAMPLE_EFFECT_BENCHMARK
+// larger sizes don't fit into memory, they are benchmarked by host/bench
+static const size_t benchmark_sizes[] = { 8, 16, 32, 64 };
+#endif
+
+#define GOLDEN_SIZE 16
+
+#ifdef CONFIG_EXAMPLE_COMMAND_TEST
+#define COMMAND_TEST_COUNT 100000
+
+static command_queue_t test_queue;
+static TaskHandle_t test_consumer;
+
+// contents of every command follow from its number
+static void test_command(command_t *cmd, uint32_t n)
+{
+    cmd->type = n;
+    cmd->value = ~n;
+    for (size_t i = 0; i < COMMAND_PARAMS; i++)
+        cmd->params[i] = n >> (i * 8);
+    cmd->fb = NULL;
+    cmd->mix = NULL;
+    cmd->draw = NULL;
+    cmd->sent = (int64_t)n << 16;
+}
+
+static void command_test_producer(void *arg)
+{
+    uint32_t *full = (uint32_t *)arg;
+    command_t cmd;
+
+    for (uint32_t n = 0; n < COMMAND_TEST_COUNT;)
+    {
+        test_command(&cmd, n);
+        if (command_queue_push(&test_queue, &cmd))
+            n++;
+        else
+            (*full)++;
+    }
+
+    xTaskNotifyGive(test_consumer);
+    vTaskDelete(NULL);
+}
+
+// push commands from the other core as fast as possible, check every popped one
+static void test_commands(void)
+{
+    uint32_t full = 0, empty = 0, errors = 0;
+    command_t cmd, expected;
+
+    command_queue_init(&test_queue);
+    test_consumer = xTaskGetCurrentTaskHandle();
+
+    int64_t start = esp_timer_get_time();
+    xTaskCreatePinnedToCore(command_test_producer, "producer", 2048, &full, 5, NULL, 0);
+    for (uint32_t n = 0; n < COMMAND_TEST_COUNT;)
+    {
+        if (!command_queue_pop(&test_queue, &cmd))
+        {
+            empty++;
+            continue;
+        }
+        test_command(&expected, n++);
+        if (cmd.type != expected.type || cmd.value != expected.value || cmd.sent != expected.sent
+                || memcmp(cmd.params, expected.params, COMMAND_PARAMS))
+            errors++;
+    }
+    int64_t elapsed = esp_timer_get_time() - start;
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+
+    ESP_LOGI(TAG, "Command queue test: %u commands in %lld us, %u errors, full %u times, empty %u times",
+            COMMAND_TEST_COUNT, elapsed, errors, full, empty);
+}
+#endif
 
-typedef enum {
-    EFFECT_NONE = 0,
+// all zones have the same layout
+static layout_panel_t panels[PANEL_COLS * ZONE_PANEL_ROWS];
 
-    EFFECT_DNA,
-    EFFECT_NOISE,
-    EFFECT_WATERFALL_FIRE,
-    EFFECT_WATERFALL,
-    EFFECT_PLASMA_WAVES,
-    EFFECT_RAINBOW,
-    EFFECT_RAYS,
-    EFFECT_CRAZYBEES,
-    EFFECT_SPARKLES,
-    EFFECT_MATRIX,
-    EFFECT_RAIN,
-    EFFECT_FIRE,
+static const layout_t layout = {
+    .panel_width = PANEL_WIDTH,
+    .panel_height = PANEL_HEIGHT,
+    .cols = PANEL_COLS,
+    .rows = ZONE_PANEL_ROWS,
+    .panels = panels,
+};
 
-    EFFECT_MAX
-} effect_t;
+static const int lane_gpio[LED_LANES] = {
+    LED_GPIO,
+#if LED_LANES > 1
+    CONFIG_EXAMPLE_LED_LANE1_GPIO,
+#endif
+#if LED_LANES > 2
+    CONFIG_EXAMPLE_LED_LANE2_GPIO,
+#endif
+#if LED_LANES > 3
+    CONFIG_EXAMPLE_LED_LANE3_GPIO,
+#endif
+};
 
-// renderer from framebuffer to actual LED strip
-// this can be easily adapted to led_strip_spi or any display
-static esp_err_t render_frame(framebuffer_t *fb, void *arg)
+// rows of panels of a zone are split between its lanes, every lane is a chain of its rows of panels
+static void setup_layout()
 {
-    if (!arg)
-        return ESP_ERR_INVALID_ARG;
+    size_t rows_per_lane = (ZONE_PANEL_ROWS + ZONE_LANES - 1) / ZONE_LANES;
 
-    led_strip_t *led_strip = (led_strip_t *)arg;
+    for (size_t row = 0; row < ZONE_PANEL_ROWS; row++)
+    {
+#ifdef CONFIG_EXAMPLE_LED_LANES_INTERLEAVED
+        size_t lane = row % ZONE_LANES;
+        size_t chain_row = row / ZONE_LANES;
+#else
+        size_t lane = row / rows_per_lane;
+        size_t chain_row = row % rows_per_lane;
+#endif
+        // odd rows of chain go from right to left, panels are upside down
+        bool reverse = PANEL_CHAIN_SERPENTINE && chain_row % 2;
 
-    for (size_t y = 0; y < fb->height; y++)
-        for (size_t x = 0; x < fb->width; x++)
+        for (size_t col = 0; col < PANEL_COLS; col++)
         {
-            // calculate strip index of pixel
-            size_t strip_idx = y * fb->width + (y % 2 ? fb->width - x - 1 : x);
-            // find pixel offset in state frame buffer
-            rgb_t color = fb->data[FB_OFFSET(fb, x, y)];
-            // limit brightness and consuming current
-            color = rgb_scale_video(color, LED_BRIGHTNESS);
-            CHECK(led_strip_set_pixel(led_strip, strip_idx, color));
+            layout_panel_t *panel = &panels[row * PANEL_COLS + col];
+            panel->rotation = reverse ? LAYOUT_ROTATE_180 : LAYOUT_ROTATE_0;
+            panel->flip = false;
+            panel->wiring = PANEL_WIRING;
+            panel->lane = lane;
+            panel->position = chain_row * PANEL_COLS + (reverse ? PANEL_COLS - col - 1 : col);
         }
+    }
+}
+
+// output stage of zone `num` drives lanes `num * ZONE_LANES` ..
+static esp_err_t init_output(output_t *out, size_t num, const output_backend_t *backend)
+{
+    output_config_t config = {
+        .backend = backend,
+        .layout = &layout,
+        .brightness = LED_BRIGHTNESS,
+        .gamma = LED_GAMMA,
+        .white = { .r = LED_WHITE_R, .g = LED_WHITE_G, .b = LED_WHITE_B },
+        .max_current = LED_MAX_CURRENT / ZONES,
+        .channel_current = LED_CHANNEL_CURRENT,
+        .idle_current = LED_IDLE_CURRENT,
+        .num_lanes = ZONE_LANES,
+        // RMT channels, SPI hosts and frame log lanes of zones don't overlap
+        .first_lane = num * ZONE_LANES,
+    };
+    for (size_t i = 0; i < ZONE_LANES; i++)
+        config.gpio[i] = lane_gpio[num * ZONE_LANES + i];
 
-    // flush strip buffer
-    return led_strip_flush(led_strip);
+    return output_init(out, &config);
 }
 
-static led_strip_t strip = {
-    .type = LED_TYPE,
-    .length = LED_MATRIX_WIDTH * LED_MATRIX_HEIGHT,
-    .gpio = LED_GPIO,
-    .buf = NULL,
+#ifdef CONFIG_EXAMPLE_OUTPUT_BENCHMARK
+#define BENCHMARK_FRAMES 100
+
+// compare per-pixel led_strip_set_pixel() path with bulk output_write(),
+// both correct colors with the same tables, check if the frame changed and
+// sum current for the limiter. Runs before output stages take LED pins.
+static void benchmark_output(void)
+{
+    framebuffer_t fb;
+    ESP_ERROR_CHECK(fb_init(&fb, ZONE_WIDTH, ZONE_HEIGHT, output_render));
+    for (size_t i = 0; i < fb.width * fb.height; i++)
+        fb.data[i] = rgb_from_values(i * 3, i * 5, i * 7);
+
+    // bulk stage on mock backend, its buffer is what led_strip transmits
+    output_t out;
+    ESP_ERROR_CHECK(init_output(&out, 0, &output_backend_mock));
+
+    // installed strip, never flushed: transmission takes the same time on both paths
+    led_strip_t strip = {
+        .type = LED_TYPE,
+        .length = fb.width * fb.height,
+        .gpio = LED_GPIO,
+        .channel = RMT_CHANNEL_0,
+        .buf = NULL,
 #ifdef LED_STRIP_BRIGHTNESS
-    .brightness = 255,
+        .brightness = 255,
 #endif
+    };
+    led_strip_install();
+    ESP_ERROR_CHECK(led_strip_init(&strip));
+    size_t size = strip.length * OUTPUT_COLOR_SIZE;
+    uint8_t *prev = calloc(1, size);
+    ESP_ERROR_CHECK(prev ? ESP_OK : ESP_ERR_NO_MEM);
+
+    volatile uint32_t sink = 0;
+    uint32_t start = esp_cpu_get_ccount();
+    for (size_t i = 0; i < BENCHMARK_FRAMES; i++)
+    {
+        uint32_t sum = 0;
+        for (size_t y = 0; y < fb.height; y++)
+            for (size_t x = 0; x < fb.width; x++)
+            {
+                size_t strip_idx = y * fb.width + (y % 2 ? fb.width - x - 1 : x);
+                rgb_t c = fb.data[FB_OFFSET(&fb, x, y)];
+                c = rgb_from_values(out.lut[0][c.r], out.lut[1][c.g], out.lut[2][c.b]);
+                sum += c.r + c.g + c.b;
+                led_strip_set_pixel(&strip, strip_idx, c);
+            }
+        bool dirty = memcmp(prev, strip.buf, size) != 0;
+        memcpy(prev, strip.buf, size);
+        sink += sum + dirty;
+    }
+    uint32_t per_pixel = (esp_cpu_get_ccount() - start) / BENCHMARK_FRAMES;
+
+    start = esp_cpu_get_ccount();
+    for (size_t i = 0; i < BENCHMARK_FRAMES; i++)
+        output_write(&out, &fb);
+    uint32_t bulk = (esp_cpu_get_ccount() - start) / BENCHMARK_FRAMES;
+
+    ESP_LOGI(TAG, "Output stage, cycles per %ux%u frame: per-pixel %u, bulk %u",
+            fb.width, fb.height, per_pixel, bulk);
+
+    free(prev);
+    led_strip_free(&strip);
+    output_free(&out);
+    fb_free(&fb);
+}
+#endif
+
+// every effect plays in its own framebuffer and takes state from its own
+// arena, so the outgoing one keeps running during crossfade
+typedef struct
+{
+    uint8_t arena_buf[LED_EFFECT_ARENA_SIZE(ZONE_WIDTH, ZONE_HEIGHT)]
+        __attribute__((aligned(LED_EFFECT_ALIGN)));
+    led_effect_arena_t arena;
+    framebuffer_t fb;
+    const led_effect_t *effect;
+} effect_slot_t;
+
+// zone plays its own effects at its own FPS on its own output stage
+typedef struct
+{
+    size_t num;
+    output_t output;
+    player_t player;
+    effect_slot_t slots[2];
+    size_t current_slot;
+    framebuffer_t mix_fb; // crossfade frames are blended here
+    bool finishing;       // crossfade not finished yet, idle slot may still be played
+#ifdef CONFIG_EXAMPLE_COMMAND_TEST
+    uint8_t brightness;   // brightness sent last
+#endif
+} zone_t;
+
+static zone_t zones[ZONES];
+// frames of all zones are rendered from a single timer
+static scheduler_t scheduler;
+
+static led_effect_rng_t effect_rng;
+static size_t next_effect = 0;
+
+// commands of this example, executed by command handler on render side
+enum {
+    CMD_PARAMS = PLAYER_CMD_USER, // publish `params` to the playing effect
+    CMD_BRIGHTNESS,               // set brightness to `value`
 };
 
-static effect_t current_effect = EFFECT_NONE;
-static fb_draw_cb_t effect_done = NULL;
-
-static void switch_effect(fb_animation_t *animation)
-{
-    // stop rendering
-    if (current_effect != EFFECT_NONE)
-        fb_animation_stop(animation);
-
-    // finish current effect
-    if (effect_done)
-        effect_done(animation->fb);
-
-    // clear framebuffer
-    fb_clear(animation->fb);
-
-    // pick new effect
-    if (++current_effect == EFFECT_MAX)
-        current_effect = EFFECT_NONE + 1;
-
-    // init new effect
-    fb_draw_cb_t effect_func = NULL;
-    switch(current_effect)
-    {
-        case EFFECT_DNA:
-            led_effect_dna_init(animation->fb, random8_between(10, 100), random8_between(1, 10), random8_to(2));
-            effect_func = led_effect_dna_run;
-            effect_done = led_effect_dna_done;
-            break;
-        case EFFECT_NOISE:
-            led_effect_noise_init(animation->fb, random8_between(10, 100), random8_between(1, 50));
-            effect_func = led_effect_noise_run;
-            effect_done = led_effect_noise_done;
-            break;
-        case EFFECT_WATERFALL_FIRE:
-            led_effect_waterfall_init(animation->fb, random8_between(2, 4), 0, random8_between(20, 120), random8_between(50, 200));
-            effect_func = led_effect_waterfall_run;
-            effect_done = led_effect_waterfall_done;
-            break;
-        case EFFECT_WATERFALL:
-            led_effect_waterfall_init(animation->fb, random8_to(2), random8_between(1, 255), random8_between(20, 120), random8_between(50, 200));
-            effect_func = led_effect_waterfall_run;
-            effect_done = led_effect_waterfall_done;
-            break;
-        case EFFECT_PLASMA_WAVES:
-            led_effect_plasma_waves_init(animation->fb, random8_between(50, 255));
-            effect_func = led_effect_plasma_waves_run;
-            effect_done = led_effect_plasma_waves_done;
-            break;
-        case EFFECT_RAINBOW:
-            led_effect_rainbow_init(animation->fb, random8_to(3), random8_between(10, 50), random8_between(1, 20));
-            effect_func = led_effect_rainbow_run;
-            effect_done = led_effect_rainbow_done;
-            break;
-        case EFFECT_RAYS:
-            led_effect_rays_init(animation->fb, random8_between(0, 50), random8_between(3, 5), random8_between(5, 10));
-            effect_func = led_effect_rays_run;
-            effect_done = led_effect_rays_done;
-            break;
-        case EFFECT_CRAZYBEES:
-            led_effect_crazybees_init(animation->fb, random8_between(2, 5));
-            effect_func = led_effect_crazybees_run;
-            effect_done = led_effect_crazybees_done;
-            break;
-        case EFFECT_SPARKLES:
-            led_effect_sparkles_init(animation->fb, random8_between(1, 20), random8_between(10, 150));
-            effect_func = led_effect_sparkles_run;
-            effect_done = led_effect_sparkles_done;
-            break;
-        case EFFECT_MATRIX:
-            led_effect_matrix_init(animation->fb, random8_between(10, 250));
-            effect_func = led_effect_matrix_run;
-            effect_done = led_effect_matrix_done;
-            break;
-        case EFFECT_RAIN:
-            led_effect_rain_init(animation->fb, random8_to(2), random8(), random8_to(100), random8_between(100, 200));
-            effect_func = led_effect_rain_run;
-            effect_done = led_effect_rain_done;
-            break;
-        case EFFECT_FIRE:
-            led_effect_fire_init(animation->fb, random8_to(3));
-            effect_func = led_effect_fire_run;
-            effect_done = led_effect_fire_done;
-            break;
+#ifdef CONFIG_EXAMPLE_PROFILE
+static void log_profile(const char *name, const profile_hist_t *hist)
+{
+    ESP_LOGI(TAG, "  %s cycles: min %u, p50 %u, p99 %u, max %u (%u frames)", name, hist->min,
+            profile_hist_percentile(hist, 50), profile_hist_percentile(hist, 99), hist->max, hist->count);
+}
+#endif
+
+// both effects and blending must keep min FPS during crossfade
+static bool crossfade_fits(const led_effect_t *from, const led_effect_t *to)
+{
+    uint64_t cycles = led_effect_frame_cycles(from, ZONE_WIDTH, ZONE_HEIGHT)
+            + led_effect_frame_cycles(to, ZONE_WIDTH, ZONE_HEIGHT)
+            + (uint64_t)BLEND_CYCLES_PER_PIXEL * ZONE_WIDTH * ZONE_HEIGHT;
+
+    return cycles * MIN_FPS <= EFFECT_CPU_HZ;
+}
+
+// finish effect of the slot, choose the next one and init it with random
+// parameters; runs in the main task while the other slot is played
+static void prepare_effect(effect_slot_t *slot)
+{
+    if (slot->effect)
+    {
+        slot->effect->done(&slot->fb);
+        slot->effect = NULL;
+    }
+
+    // effects failing to init are skipped, at most one round
+    for (size_t attempt = 0; attempt < led_effects_count && !slot->effect; attempt++)
+    {
+        led_effect_arena_reset(&slot->arena);
+
+        // clear framebuffer
+        fb_clear(&slot->fb);
+
+        // pick next effect able to keep min FPS at this matrix size
+        const led_effect_t *effect = NULL;
+        for (size_t i = 0; i < led_effects_count && !effect; i++)
+        {
+            const led_effect_t *e = led_effects[next_effect];
+            next_effect = (next_effect + 1) % led_effects_count;
+            if (led_effect_fits(e, ZONE_WIDTH, ZONE_HEIGHT, MIN_FPS, EFFECT_CPU_HZ))
+                effect = e;
+            else
+                ESP_LOGW(TAG, "Skipping effect %s, too slow for %d FPS", e->name, MIN_FPS);
+        }
+        // nothing fits, play them all anyway
+        if (!effect)
+        {
+            effect = led_effects[next_effect];
+            next_effect = (next_effect + 1) % led_effects_count;
+        }
+
+        // init new effect with random parameters, its clock starts with its first frame
+        uint8_t params[LED_EFFECT_MAX_PARAMS];
+        led_effect_random_params(effect, &effect_rng, params);
+        esp_err_t res = effect->init(&slot->fb, params);
+        if (res != ESP_OK)
+        {
+            ESP_LOGE(TAG, "Could not init effect %s: %d", effect->name, res);
+            effect->done(&slot->fb);
+            continue;
+        }
+        slot->effect = effect;
+    }
+    if (!slot->effect)
+        led_effect_arena_reset(&slot->arena);
+}
+
+static void log_stats(zone_t *zone, const led_effect_t *effect)
+{
+    player_t *player = &zone->player;
+    const player_stats_t *stats = &player->stats;
+    ESP_LOGI(TAG, "Zone %u, effect %s: %u frames, %u deadline misses, last FPS %d, draw %u us, render %u us, max %u us, "
+            "max gap %u us", zone->num, effect->name, stats->frames, stats->missed, player->fps,
+            stats->draw_us, stats->render_us, stats->max_us, stats->max_gap_us);
+    if (stats->commands)
+        ESP_LOGI(TAG, "  commands: %u, latency %u us, max %u us", stats->commands, stats->latency_us,
+                stats->max_latency_us);
+    if (stats->blended)
+        ESP_LOGI(TAG, "  crossfade: %u frames, blend %u us", stats->blended, stats->blend_us);
+#ifdef CONFIG_EXAMPLE_PROFILE
+    log_profile("compute", &player->compute);
+    log_profile("blend", &player->blend);
+    log_profile("output", &player->output);
+#endif
+    ESP_LOGI(TAG, "  output: %u frames flushed, %u skipped as unchanged, %u mA estimated, %u frames limited",
+            zone->output.flushed, zone->output.skipped, zone->output.current, zone->output.limited);
+}
+
+static effect_slot_t *find_slot(zone_t *zone, const framebuffer_t *fb)
+{
+    for (size_t i = 0; i < 2; i++)
+        if (&zone->slots[i].fb == fb)
+            return &zone->slots[i];
+
+    return NULL;
+}
+
+static esp_err_t execute_command(const command_t *cmd, void *ctx)
+{
+    zone_t *zone = (zone_t *)ctx;
+    player_t *player = &zone->player;
+
+    switch (cmd->type)
+    {
+        case CMD_PARAMS:
+        {
+            // incoming effect during crossfade
+            framebuffer_t *fb = player->next_fb ? player->next_fb : player->fb;
+            effect_slot_t *slot = find_slot(zone, fb);
+            if (!slot || !slot->effect)
+                return ESP_ERR_INVALID_STATE;
+            return slot->effect->set_params(fb, cmd->params);
+        }
+        case CMD_BRIGHTNESS:
+            return output_set_brightness(&zone->output, cmd->value);
         default:
-            break;
+            return ESP_ERR_NOT_SUPPORTED;
+    }
+}
+
+// finish crossfade, until then the idle slot is not reused
+static void finish_switch(zone_t *zone)
+{
+    esp_err_t res = player_finish_crossfade(&zone->player);
+    // nothing is played if the player stopped
+    zone->finishing = res != ESP_OK && res != ESP_ERR_INVALID_STATE;
+    if (zone->finishing)
+    {
+        ESP_LOGW(TAG, "Zone %u: could not finish crossfade: %d, keeping idle slot until the next switch",
+                zone->num, res);
+        return;
+    }
+#ifdef CONFIG_EXAMPLE_COMMAND_TEST
+    // commands sent before are executed by now
+    if (res == ESP_OK && zone->output.brightness != zone->brightness)
+        ESP_LOGE(TAG, "Zone %u: brightness is %u, %u was sent", zone->num, zone->output.brightness,
+                zone->brightness);
+#endif
+}
+
+// switch to the effect prepared in the other slot, render side only swaps pointers
+static void switch_effect(zone_t *zone)
+{
+    effect_slot_t *current = &zone->slots[zone->current_slot];
+    effect_slot_t *next = &zone->slots[zone->current_slot ^ 1];
+
+    // finishing or preparing failed last time, try again now
+    if (zone->finishing)
+    {
+        finish_switch(zone);
+        if (zone->finishing)
+            return;
+        prepare_effect(next);
+    }
+    else if (!next->effect)
+        prepare_effect(next);
+    if (!next->effect)
+        return;
+
+    log_stats(zone, current->effect);
+
+    command_t cmd = {
+        .type = PLAYER_CMD_CROSSFADE,
+        .value = TRANSITION_MS,
+        .fb = &next->fb,
+        .mix = &zone->mix_fb,
+        .draw = next->effect->run,
+    };
+    if (!crossfade_fits(current->effect, next->effect))
+    {
+        ESP_LOGW(TAG, "Zone %u: crossfade %s -> %s too slow for %d FPS, switching at once",
+                zone->num, current->effect->name, next->effect->name, MIN_FPS);
+        cmd.value = 0;
+    }
+    if (player_send(&zone->player, &cmd) != ESP_OK)
+    {
+        ESP_LOGW(TAG, "Zone %u: command queue is full, not switching", zone->num);
+        return;
+    }
+    zone->current_slot ^= 1;
+    ESP_LOGI(TAG, "Zone %u: switching to effect: %s", zone->num, next->effect->name);
+}
+
+// new random parameters of the effect main task switched to last
+static void change_params(zone_t *zone)
+{
+    const led_effect_t *effect = zone->slots[zone->current_slot].effect;
+    if (!effect || !effect->num_params)
+        return;
+
+    command_t cmd = { .type = CMD_PARAMS };
+    led_effect_random_params(effect, &effect_rng, cmd.params);
+    if (player_send(&zone->player, &cmd) != ESP_OK)
+    {
+        ESP_LOGW(TAG, "Zone %u: command queue is full, not changing parameters", zone->num);
+        return;
+    }
+    ESP_LOGI(TAG, "Zone %u: new parameters of effect %s", zone->num, effect->name);
+}
+
+#ifdef CONFIG_EXAMPLE_COMMAND_TEST
+// dim to half brightness every other period, checked after the next finish
+static void change_brightness(zone_t *zone, uint32_t period)
+{
+    command_t cmd = {
+        .type = CMD_BRIGHTNESS,
+        .value = period & 1 ? LED_BRIGHTNESS / 2 : LED_BRIGHTNESS,
+    };
+    if (player_send(&zone->player, &cmd) != ESP_OK)
+    {
+        ESP_LOGW(TAG, "Zone %u: command queue is full, not changing brightness", zone->num);
+        return;
+    }
+    zone->brightness = cmd.value;
+}
+#endif
+
+#ifdef CONFIG_EXAMPLE_OUTPUT_BACKEND_MOCK
+#define SEMIHOST_PATH "/host"
+
+static void start_frame_log(void)
+{
+    static frame_log_t frame_log;
+
+    if (!strlen(CONFIG_EXAMPLE_OUTPUT_MOCK_LOG))
+        return;
+
+    // written on the host running OpenOCD
+    if (!strncmp(CONFIG_EXAMPLE_OUTPUT_MOCK_LOG, SEMIHOST_PATH "/", sizeof(SEMIHOST_PATH)))
+    {
+#if ESP_IDF_VERSION >= ESP_IDF_VERSION_VAL(5, 0, 0)
+        esp_err_t res = esp_vfs_semihost_register(SEMIHOST_PATH);
+#else
+        esp_err_t res = esp_vfs_semihost_register(SEMIHOST_PATH, NULL);
+#endif
+        if (res != ESP_OK)
+        {
+            ESP_LOGE(TAG, "Could not register semihosting file system: %d", res);
+            return;
+        }
     }
 
-    // start rendering
-    fb_animation_play(animation, FPS, effect_func, &strip);
+    FILE *f = fopen(CONFIG_EXAMPLE_OUTPUT_MOCK_LOG, "wb");
+    if (!f)
+    {
+        ESP_LOGE(TAG, "Could not open frame log %s", CONFIG_EXAMPLE_OUTPUT_MOCK_LOG);
+        return;
+    }
+#ifdef CONFIG_EXAMPLE_OUTPUT_MOCK_LOG_DATA
+    uint16_t flags = FRAME_LOG_DATA;
+#else
+    uint16_t flags = 0;
+#endif
+    ESP_ERROR_CHECK(frame_log_init(&frame_log, f, flags, esp_timer_get_time));
+    output_backend_mock_set_log(&frame_log);
+    ESP_LOGI(TAG, "Recording frames to %s", CONFIG_EXAMPLE_OUTPUT_MOCK_LOG);
 }
+#endif
 
 void test(void *pvParameters)
 {
-    // setup strip
-    led_strip_init(&strip);
-    ESP_LOGI(TAG, "LED strip initialized");
+    // setup LED strips and output stages
+    setup_layout();
+#ifdef CONFIG_EXAMPLE_OUTPUT_BENCHMARK
+    benchmark_output();
+#endif
+    for (size_t z = 0; z < ZONES; z++)
+    {
+        zone_t *zone = &zones[z];
+        zone->num = z;
+        ESP_ERROR_CHECK(init_output(&zone->output, z, &OUTPUT_BACKEND));
+        ESP_LOGI(TAG, "Zone %u: LED strips initialized, %d lane(s), output stage uses %u bytes",
+                z, ZONE_LANES, output_get_memory(&zone->output));
 
-    // Setup framebuffer
-    framebuffer_t fb;
-    fb_init(&fb, LED_MATRIX_WIDTH, LED_MATRIX_HEIGHT, render_frame);
+        // Setup framebuffers of effects and of crossfade
+        for (size_t i = 0; i < 2; i++)
+            ESP_ERROR_CHECK(fb_init(&zone->slots[i].fb, ZONE_WIDTH, ZONE_HEIGHT, output_render));
+        ESP_ERROR_CHECK(fb_init(&zone->mix_fb, ZONE_WIDTH, ZONE_HEIGHT, output_render));
+    }
+
+    // random streams of effects and of their parameters
+    led_effect_set_seed(CONFIG_EXAMPLE_EFFECT_SEED);
+    led_effect_rng_init(&effect_rng);
 
-    // setup animation
-    fb_animation_t animation;
-    fb_animation_init(&animation, &fb);
+#ifdef CONFIG_EXAMPLE_EFFECT_TILES
+    // a worker on every core, scheduler is the only caller
+    ESP_ERROR_CHECK(led_effect_tiles_init(&tiles, portNUM_PROCESSORS));
+#endif
+
+#ifdef CONFIG_EXAMPLE_EFFECT_BENCHMARK
+#ifdef CONFIG_EXAMPLE_EFFECT_TILES
+    ESP_ERROR_CHECK(led_effect_benchmark(benchmark_sizes, sizeof(benchmark_sizes) / sizeof(benchmark_sizes[0]),
+            CONFIG_EXAMPLE_EFFECT_BENCHMARK_FRAMES, &tiles));
+#else
+    ESP_ERROR_CHECK(led_effect_benchmark(benchmark_sizes, sizeof(benchmark_sizes) / sizeof(benchmark_sizes[0]),
+            CONFIG_EXAMPLE_EFFECT_BENCHMARK_FRAMES, NULL));
+#endif
+#endif
+
+#ifdef CONFIG_EXAMPLE_EFFECT_GOLDEN
+    ESP_ERROR_CHECK(led_effect_golden(GOLDEN_SIZE, CONFIG_EXAMPLE_EFFECT_GOLDEN_FRAMES));
+    led_effect_set_seed(CONFIG_EXAMPLE_EFFECT_SEED);
+#endif
 
-    while (1)
+#ifdef CONFIG_EXAMPLE_COMMAND_TEST
+    test_commands();
+#endif
+
+#ifdef CONFIG_EXAMPLE_OUTPUT_BACKEND_MOCK
+    start_frame_log();
+#endif
+
+    // effects take their state from arena
+    for (size_t z = 0; z < ZONES; z++)
+        for (size_t i = 0; i < 2; i++)
+        {
+            effect_slot_t *slot = &zones[z].slots[i];
+            ESP_ERROR_CHECK(led_effect_arena_init(&slot->arena, slot->arena_buf, sizeof(slot->arena_buf)));
+            ESP_ERROR_CHECK(led_effect_arena_attach(&slot->fb, &slot->arena));
+        }
+
+    size_t state_size = 0;
+    for (size_t i = 0; i < led_effects_count; i++)
+        state_size = MAX(state_size, led_effect_state_size(led_effects[i], ZONE_WIDTH, ZONE_HEIGHT));
+    ESP_LOGI(TAG, "%u effects registered, state of an effect takes up to %u bytes, arena has %u bytes",
+            led_effects_count, state_size, sizeof(zones[0].slots[0].arena_buf));
+
+    // setup players, frames of all zones are rendered by scheduler
+    ESP_ERROR_CHECK(scheduler_init(&scheduler));
+    for (size_t z = 0; z < ZONES; z++)
     {
-        switch_effect(&animation);
-        ESP_LOGI(TAG, "Switching to effect: %d", current_effect);
-        vTaskDelay(pdMS_TO_TICKS(SWITCH_PERIOD_MS));
+        zone_t *zone = &zones[z];
+        ESP_ERROR_CHECK(player_init_scheduled(&zone->player, &zone->slots[0].fb, MIN_FPS, FPS));
+        ESP_ERROR_CHECK(player_set_command_handler(&zone->player, execute_command, zone));
+        ESP_ERROR_CHECK(scheduler_add(&scheduler, &zone->player));
+#ifdef CONFIG_EXAMPLE_COMMAND_TEST
+        zone->brightness = LED_BRIGHTNESS;
+#endif
+    }
+#ifdef CONFIG_EXAMPLE_EFFECT_TILES
+    led_effect_set_tiles(&tiles);
+#endif
+
+    // start rendering, FPS of every zone follows cost of its effect
+    for (size_t z = 0; z < ZONES; z++)
+    {
+        zone_t *zone = &zones[z];
+        prepare_effect(&zone->slots[0]);
+        if (!zone->slots[0].effect)
+        {
+            ESP_LOGE(TAG, "Could not init any effect");
+            vTaskDelete(NULL);
+        }
+        ESP_LOGI(TAG, "Zone %u: starting with effect: %s", z, zone->slots[0].effect->name);
+        scheduler_play(&scheduler, &zone->player, zone->slots[0].effect->run, &zone->output);
+    }
+
+    TickType_t wake = xTaskGetTickCount();
+    for (uint32_t period = 0; ; period++)
+    {
+        // next effects are initialized while the current ones play
+        for (size_t z = 0; z < ZONES; z++)
+            if (!zones[z].finishing)
+                prepare_effect(&zones[z].slots[zones[z].current_slot ^ 1]);
+
+        // playing effects change parameters halfway, without restarting
+        vTaskDelayUntil(&wake, pdMS_TO_TICKS(SWITCH_PERIOD_MS / 2));
+        for (size_t z = 0; z < ZONES; z++)
+        {
+            change_params(&zones[z]);
+#ifdef CONFIG_EXAMPLE_COMMAND_TEST
+            change_brightness(&zones[z], period);
+#endif
+        }
+
+        vTaskDelayUntil(&wake, pdMS_TO_TICKS(SWITCH_PERIOD_MS - SWITCH_PERIOD_MS / 2));
+        for (size_t z = 0; z < ZONES; z++)
+            switch_effect(&zones[z]);
+        ESP_LOGI(TAG, "Scheduler: %u frames in %u runs, max %u us late", scheduler.stats.frames,
+                scheduler.stats.runs, scheduler.stats.max_late);
+        scheduler_reset_stats(&scheduler);
+
+        // outgoing effects play until crossfade is over, then their slots are reused
+        vTaskDelay(pdMS_TO_TICKS(TRANSITION_MS));
+        for (size_t z = 0; z < ZONES; z++)
+            finish_switch(&zones[z]);
     }
 }
 
 void app_main()
 {
-    led_strip_install();
-    xTaskCreate(test, "test", 8192, NULL, 5, NULL);
+    // effects are initialized on the core esp_timer task doesn't run on
+    xTaskCreatePinnedToCore(test, "test", 8192, NULL, 5, NULL, portNUM_PROCESSORS - 1);
 }
 
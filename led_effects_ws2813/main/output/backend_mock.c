@@ -0,0 +1,83 @@
+/**
+ * @file backend_mock.c
+ *
+ * Mock output backend, keeps flushed lane data in memory
+ * and optionally records it into frame log
+ */
+#include <stdlib.h>
+#include <string.h>
+
+#include "output/backends.h"
+
+#define CHECK_ARG(VAL) do { if (!(VAL)) return ESP_ERR_INVALID_ARG; } while (0)
+
+typedef struct
+{
+    uint32_t frames;
+    uint8_t data[];
+} lane_t;
+
+static frame_log_t *frame_log = NULL;
+
+static esp_err_t mock_init(output_lane_t *lane)
+{
+    CHECK_ARG(lane);
+
+    lane->ctx = calloc(1, sizeof(lane_t) + lane->length * OUTPUT_COLOR_SIZE);
+    if (!lane->ctx)
+        return ESP_ERR_NO_MEM;
+
+    return ESP_OK;
+}
+
+static esp_err_t mock_free(output_lane_t *lane)
+{
+    CHECK_ARG(lane);
+
+    if (lane->ctx)
+        free(lane->ctx);
+    lane->ctx = NULL;
+
+    return ESP_OK;
+}
+
+static esp_err_t mock_flush(output_lane_t *lane, const uint8_t *data, size_t size)
+{
+    CHECK_ARG(lane && lane->ctx && data && size == lane->length * OUTPUT_COLOR_SIZE);
+
+    lane_t *l = (lane_t *)lane->ctx;
+    memcpy(l->data, data, size);
+    l->frames++;
+
+    if (frame_log)
+        return frame_log_write(frame_log, lane->num, l->frames, data, size);
+
+    return ESP_OK;
+}
+
+void output_backend_mock_set_log(frame_log_t *log)
+{
+    frame_log = log;
+}
+
+const uint8_t *output_backend_mock_data(const output_lane_t *lane)
+{
+    if (!lane || !lane->ctx)
+        return NULL;
+
+    return ((lane_t *)lane->ctx)->data;
+}
+
+uint32_t output_backend_mock_frames(const output_lane_t *lane)
+{
+    if (!lane || !lane->ctx)
+        return 0;
+
+    return ((lane_t *)lane->ctx)->frames;
+}
+
+const output_backend_t output_backend_mock = {
+    .init = mock_init,
+    .free = mock_free,
+    .flush = mock_flush,
+};
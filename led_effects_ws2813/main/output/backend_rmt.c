@@ -0,0 +1,136 @@
+/**
+ * @file backend_rmt.c
+ *
+ * RMT output backend, one RMT channel per lane
+ *
+ * Lane N uses RMT channel N. Frame buffers of the output stage are
+ * transmitted directly: the RMT driver calls translator from ISR to encode
+ * next small chunk of bytes into RMT items in ping-pong fashion, so no
+ * expanded item buffer or strip buffer is allocated, memory usage does not
+ * depend on strip length.
+ */
+#include <driver/rmt.h>
+#include <esp_attr.h>
+#include <esp_rom_sys.h>
+#include <stdlib.h>
+
+#include "output/backends.h"
+
+#define CHECK(x) do { esp_err_t __; if ((__ = x) != ESP_OK) return __; } while (0)
+#define CHECK_ARG(VAL) do { if (!(VAL)) return ESP_ERR_INVALID_ARG; } while (0)
+
+#define CLK_DIV 2 // 40 MHz, 25 ns per tick
+
+// WS2812/WS2813 timings, ns
+#define T0H 400
+#define T0L 850
+#define T1H 800
+#define T1L 450
+#define NS_TO_TICKS(ns) ((ns) / 25)
+
+#define RESET_US 50
+#define FLUSH_TIMEOUT_MS 1000
+
+typedef struct
+{
+    rmt_channel_t channel;
+} lane_t;
+
+// read by translate() in ISR, must stay accessible while flash cache is off
+static const DRAM_ATTR rmt_item32_t bit0 = {
+    .duration0 = NS_TO_TICKS(T0H), .level0 = 1,
+    .duration1 = NS_TO_TICKS(T0L), .level1 = 0,
+};
+
+static const DRAM_ATTR rmt_item32_t bit1 = {
+    .duration0 = NS_TO_TICKS(T1H), .level0 = 1,
+    .duration1 = NS_TO_TICKS(T1L), .level1 = 0,
+};
+
+// called by RMT driver from ISR to convert next chunk of bytes
+static void IRAM_ATTR translate(const void *src, rmt_item32_t *dest, size_t src_size,
+        size_t wanted_num, size_t *translated_size, size_t *item_num)
+{
+    if (!src || !dest)
+    {
+        *translated_size = 0;
+        *item_num = 0;
+        return;
+    }
+
+    const uint8_t *psrc = (const uint8_t *)src;
+    size_t size = 0;
+    size_t num = 0;
+    while (size < src_size && num + 8 <= wanted_num)
+    {
+        uint8_t b = *psrc++;
+        for (int i = 0; i < 8; i++, b <<= 1)
+            dest[num++].val = b & 0x80 ? bit1.val : bit0.val;
+        size++;
+    }
+    *translated_size = size;
+    *item_num = num;
+}
+
+static esp_err_t rmt_init(output_lane_t *lane)
+{
+    CHECK_ARG(lane && lane->num < RMT_CHANNEL_MAX);
+
+    lane_t *l = calloc(1, sizeof(lane_t));
+    if (!l)
+        return ESP_ERR_NO_MEM;
+    l->channel = RMT_CHANNEL_0 + lane->num;
+
+    rmt_config_t config = RMT_DEFAULT_CONFIG_TX(lane->gpio, l->channel);
+    config.clk_div = CLK_DIV;
+
+    esp_err_t res = rmt_config(&config);
+    if (res == ESP_OK)
+        res = rmt_driver_install(l->channel, 0, 0);
+    if (res != ESP_OK)
+    {
+        free(l);
+        return res;
+    }
+    res = rmt_translator_init(l->channel, translate);
+    if (res != ESP_OK)
+    {
+        rmt_driver_uninstall(l->channel);
+        free(l);
+        return res;
+    }
+    lane->ctx = l;
+
+    return ESP_OK;
+}
+
+static esp_err_t rmt_free(output_lane_t *lane)
+{
+    CHECK_ARG(lane && lane->ctx);
+
+    lane_t *l = (lane_t *)lane->ctx;
+    rmt_wait_tx_done(l->channel, pdMS_TO_TICKS(FLUSH_TIMEOUT_MS));
+    esp_err_t res = rmt_driver_uninstall(l->channel);
+    free(l);
+    lane->ctx = NULL;
+
+    return res;
+}
+
+static esp_err_t rmt_flush(output_lane_t *lane, const uint8_t *data, size_t size)
+{
+    CHECK_ARG(lane && lane->ctx && data && size == lane->length * OUTPUT_COLOR_SIZE);
+
+    lane_t *l = (lane_t *)lane->ctx;
+
+    CHECK(rmt_wait_tx_done(l->channel, pdMS_TO_TICKS(FLUSH_TIMEOUT_MS)));
+    esp_rom_delay_us(RESET_US);
+
+    return rmt_write_sample(l->channel, data, size, false);
+}
+
+const output_backend_t output_backend_rmt = {
+    .init = rmt_init,
+    .free = rmt_free,
+    .flush = rmt_flush,
+};
@@ -0,0 +1,127 @@
+/**
+ * @file backend_spi.c
+ *
+ * SPI output backend, one SPI host per lane, up to 2 lanes
+ *
+ * Frame buffers are written by the output stage already encoded with
+ * ws2812_spi_encoding_init() table and are transmitted by DMA as is.
+ * Only MOSI pin is used.
+ */
+#include <driver/spi_master.h>
+#include <esp_rom_sys.h>
+#include <stdlib.h>
+
+#include "output/backends.h"
+#include "output/ws2812_spi.h"
+
+#define CHECK(x) do { esp_err_t __; if ((__ = x) != ESP_OK) return __; } while (0)
+#define CHECK_ARG(VAL) do { if (!(VAL)) return ESP_ERR_INVALID_ARG; } while (0)
+
+#define MAX_LANES 2
+#define RESET_US 50
+
+typedef struct
+{
+    spi_host_device_t host;
+    spi_device_handle_t dev;
+    spi_transaction_t trans;
+    bool busy;
+} lane_t;
+
+static uint32_t encoding[256];
+
+static esp_err_t spi_wait(lane_t *l)
+{
+    if (!l->busy)
+        return ESP_OK;
+
+    spi_transaction_t *res;
+    CHECK(spi_device_get_trans_result(l->dev, &res, portMAX_DELAY));
+    l->busy = false;
+
+    return ESP_OK;
+}
+
+static esp_err_t spi_init(output_lane_t *lane)
+{
+    CHECK_ARG(lane && lane->num < MAX_LANES);
+
+    ws2812_spi_encoding_init(encoding);
+
+    lane_t *l = calloc(1, sizeof(lane_t));
+    if (!l)
+        return ESP_ERR_NO_MEM;
+    l->host = lane->num ? SPI3_HOST : SPI2_HOST;
+
+    spi_bus_config_t bus = {
+        .mosi_io_num = lane->gpio,
+        .miso_io_num = -1,
+        .sclk_io_num = -1,
+        .quadwp_io_num = -1,
+        .quadhd_io_num = -1,
+        .max_transfer_sz = lane->length * OUTPUT_COLOR_SIZE * sizeof(uint32_t),
+    };
+    spi_device_interface_config_t dev = {
+        .clock_speed_hz = WS2812_SPI_CLOCK_HZ,
+        .mode = 0,
+        .spics_io_num = -1,
+        .queue_size = 1,
+    };
+
+    esp_err_t res = spi_bus_initialize(l->host, &bus, SPI_DMA_CH_AUTO);
+    if (res != ESP_OK)
+    {
+        free(l);
+        return res;
+    }
+    res = spi_bus_add_device(l->host, &dev, &l->dev);
+    if (res != ESP_OK)
+    {
+        spi_bus_free(l->host);
+        free(l);
+        return res;
+    }
+    lane->ctx = l;
+
+    return ESP_OK;
+}
+
+static esp_err_t spi_free(output_lane_t *lane)
+{
+    CHECK_ARG(lane && lane->ctx);
+
+    lane_t *l = (lane_t *)lane->ctx;
+    spi_wait(l);
+    spi_bus_remove_device(l->dev);
+    spi_bus_free(l->host);
+    free(l);
+    lane->ctx = NULL;
+
+    return ESP_OK;
+}
+
+static esp_err_t spi_flush(output_lane_t *lane, const uint8_t *data, size_t size)
+{
+    CHECK_ARG(lane && lane->ctx && data && size == lane->length * OUTPUT_COLOR_SIZE * sizeof(uint32_t));
+
+    lane_t *l = (lane_t *)lane->ctx;
+
+    CHECK(spi_wait(l));
+    // MOSI stays low after the last bit, keep it low long enough to latch
+    esp_rom_delay_us(RESET_US);
+
+    l->trans.length = size * 8;
+    l->trans.tx_buffer = data;
+    CHECK(spi_device_queue_trans(l->dev, &l->trans, portMAX_DELAY));
+    l->busy = true;
+
+    return ESP_OK;
+}
+
+const output_backend_t output_backend_spi = {
+    .init = spi_init,
+    .free = spi_free,
+    .flush = spi_flush,
+    .encoding = encoding,
+    .dma = true,
+};
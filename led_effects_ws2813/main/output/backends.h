@@ -0,0 +1,64 @@
+/**
+ * @file backends.h
+ *
+ * @defgroup led_output_backends led_output_backends
+ * @{
+ *
+ * Output backends
+ *
+ *   - rmt:  WS2812/WS2813 strips driven by RMT, one RMT channel per lane.
+ *           Frame is encoded into RMT items on the fly in small chunks
+ *   - spi:  WS2812/WS2813 strips driven by SPI DMA, one SPI host per lane,
+ *           up to 2 lanes. Frame is encoded by the output stage directly
+ *           into DMA buffer
+ *   - mock: keeps the last flushed data of every lane in memory, no hardware
+ *           is used. Does not depend on ESP-IDF drivers, so it can be used to
+ *           check lane splitting without LEDs. Every flushed frame can be
+ *           recorded into frame log
+ */
+#ifndef __LED_OUTPUT_BACKENDS_H__
+#define __LED_OUTPUT_BACKENDS_H__
+
+#include "output/output.h"
+#include "output/frame_log.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+extern const output_backend_t output_backend_rmt;
+
+extern const output_backend_t output_backend_spi;
+
+extern const output_backend_t output_backend_mock;
+
+/**
+ * @brief Record frames flushed to all mock lanes
+ *
+ * @param log Started frame log, NULL to stop recording
+ */
+void output_backend_mock_set_log(frame_log_t *log);
+
+/**
+ * @brief Get data of the last frame flushed to the mock lane
+ *
+ * @param lane Lane
+ * @return Pointer to `lane->length * OUTPUT_COLOR_SIZE` bytes or NULL
+ */
+const uint8_t *output_backend_mock_data(const output_lane_t *lane);
+
+/**
+ * @brief Get number of frames flushed to the mock lane
+ *
+ * @param lane Lane
+ * @return Number of frames
+ */
+uint32_t output_backend_mock_frames(const output_lane_t *lane);
+
+#ifdef __cplusplus
+}
+#endif
+
+/**@}*/
+
+#endif /* __LED_OUTPUT_BACKENDS_H__ */
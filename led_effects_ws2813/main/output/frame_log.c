@@ -0,0 +1,83 @@
+/**
+ * @file frame_log.c
+ *
+ * Binary log of flushed frames
+ */
+#include <string.h>
+
+#include "output/frame_log.h"
+
+#define CHECK_ARG(VAL) do { if (!(VAL)) return ESP_ERR_INVALID_ARG; } while (0)
+
+#define FNV_OFFSET 2166136261u
+#define FNV_PRIME  16777619u
+
+static size_t put16(uint8_t *buf, uint16_t v)
+{
+    buf[0] = v;
+    buf[1] = v >> 8;
+    return 2;
+}
+
+static size_t put32(uint8_t *buf, uint32_t v)
+{
+    put16(buf, v);
+    put16(buf + 2, v >> 16);
+    return 4;
+}
+
+static size_t put64(uint8_t *buf, uint64_t v)
+{
+    put32(buf, v);
+    put32(buf + 4, v >> 32);
+    return 8;
+}
+
+uint32_t frame_log_checksum(const uint8_t *data, size_t size)
+{
+    uint32_t h = FNV_OFFSET;
+    for (size_t i = 0; i < size; i++)
+        h = (h ^ data[i]) * FNV_PRIME;
+
+    return h;
+}
+
+esp_err_t frame_log_init(frame_log_t *log, FILE *file, uint16_t flags, int64_t (*clock)(void))
+{
+    CHECK_ARG(log && file && clock);
+
+    log->file = file;
+    log->flags = flags;
+    log->clock = clock;
+    log->start = clock();
+    log->records = 0;
+
+    uint8_t header[8];
+    memcpy(header, FRAME_LOG_MAGIC, 4);
+    put16(header + 4, FRAME_LOG_VERSION);
+    put16(header + 6, flags);
+
+    return fwrite(header, sizeof(header), 1, file) == 1 ? ESP_OK : ESP_FAIL;
+}
+
+esp_err_t frame_log_write(frame_log_t *log, uint16_t lane, uint32_t frame, const uint8_t *data, uint32_t size)
+{
+    CHECK_ARG(log && log->file && data);
+
+    uint8_t record[24];
+    size_t len = 0;
+    len += put64(record + len, log->clock() - log->start);
+    len += put16(record + len, lane);
+    len += put16(record + len, 0);
+    len += put32(record + len, frame);
+    len += put32(record + len, size);
+    len += put32(record + len, frame_log_checksum(data, size));
+
+    if (fwrite(record, len, 1, log->file) != 1)
+        return ESP_FAIL;
+    if ((log->flags & FRAME_LOG_DATA) && fwrite(data, size, 1, log->file) != 1)
+        return ESP_FAIL;
+    log->records++;
+
+    return ESP_OK;
+}
@@ -0,0 +1,88 @@
+/**
+ * @file frame_log.h
+ *
+ * @defgroup led_output_frame_log led_output_frame_log
+ * @{
+ *
+ * Binary log of flushed frames
+ *
+ * Log starts with a header followed by one record per flushed lane frame.
+ * All fields are little endian:
+ *
+ *     header: char magic[4] = "LEDF", uint16_t version, uint16_t flags
+ *     record: uint64_t time_us, uint16_t lane, uint16_t reserved,
+ *             uint32_t frame, uint32_t size, uint32_t checksum,
+ *             uint8_t data[size] if FRAME_LOG_DATA flag is set
+ *
+ * Checksum is 32-bit FNV-1a of the lane data, so logs made by different
+ * builds can be compared frame by frame without keeping data. Uses only
+ * stdio, runs on ESP-IDF and on any host.
+ */
+#ifndef __LED_OUTPUT_FRAME_LOG_H__
+#define __LED_OUTPUT_FRAME_LOG_H__
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <esp_err.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define FRAME_LOG_MAGIC   "LEDF"
+#define FRAME_LOG_VERSION 1
+
+#define FRAME_LOG_DATA 0x0001 ///< Records contain lane data
+
+/**
+ * Frame log descriptor
+ */
+typedef struct
+{
+    FILE *file;              ///< Output file
+    uint16_t flags;          ///< Log flags
+    int64_t (*clock)(void);  ///< Time source, us. Virtual clock makes logs reproducible
+    int64_t start;           ///< Time of log start, us
+    uint32_t records;        ///< Number of written records
+} frame_log_t;
+
+/**
+ * @brief Start log and write its header
+ *
+ * @param log Log descriptor
+ * @param file File opened for binary writing, stays owned by the caller
+ * @param flags Log flags
+ * @param clock Time source, us
+ * @return `ESP_OK` on success
+ */
+esp_err_t frame_log_init(frame_log_t *log, FILE *file, uint16_t flags, int64_t (*clock)(void));
+
+/**
+ * @brief Write a record of a single lane frame
+ *
+ * @param log Log descriptor
+ * @param lane Lane number
+ * @param frame Frame number of the lane
+ * @param data Lane data
+ * @param size Size of lane data in bytes
+ * @return `ESP_OK` on success
+ */
+esp_err_t frame_log_write(frame_log_t *log, uint16_t lane, uint32_t frame, const uint8_t *data, uint32_t size);
+
+/**
+ * @brief 32-bit FNV-1a checksum
+ *
+ * @param data Data
+ * @param size Size of data in bytes
+ * @return Checksum
+ */
+uint32_t frame_log_checksum(const uint8_t *data, size_t size);
+
+#ifdef __cplusplus
+}
+#endif
+
+/**@}*/
+
+#endif /* __LED_OUTPUT_FRAME_LOG_H__ */
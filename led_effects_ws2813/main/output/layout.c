@@ -0,0 +1,117 @@
+/**
+ * @file layout.c
+ *
+ * Physical layout of LEDs: grid of panels
+ */
+#include "output/layout.h"
+
+#define CHECK(x) do { esp_err_t __; if ((__ = x) != ESP_OK) return __; } while (0)
+#define CHECK_ARG(VAL) do { if (!(VAL)) return ESP_ERR_INVALID_ARG; } while (0)
+
+#define PANEL_SIZE(layout) ((layout)->panel_width * (layout)->panel_height)
+#define NUM_PANELS(layout) ((layout)->cols * (layout)->rows)
+
+esp_err_t layout_check(const layout_t *layout, size_t num_lanes)
+{
+    CHECK_ARG(layout && layout->panels && layout->panel_width && layout->panel_height && layout->cols && layout->rows);
+
+    for (size_t i = 0; i < NUM_PANELS(layout); i++)
+    {
+        const layout_panel_t *p = &layout->panels[i];
+        if (p->lane >= num_lanes || p->rotation > LAYOUT_ROTATE_270 || p->wiring > LAYOUT_WIRING_PROGRESSIVE)
+            return ESP_ERR_INVALID_ARG;
+        for (size_t j = 0; j < i; j++)
+            if (layout->panels[j].lane == p->lane && layout->panels[j].position == p->position)
+                return ESP_ERR_INVALID_ARG;
+    }
+
+    return ESP_OK;
+}
+
+esp_err_t layout_get_lengths(const layout_t *layout, size_t num_lanes, size_t *lengths)
+{
+    CHECK(layout_check(layout, num_lanes));
+    CHECK_ARG(lengths);
+
+    for (size_t l = 0; l < num_lanes; l++)
+        lengths[l] = 0;
+    for (size_t i = 0; i < NUM_PANELS(layout); i++)
+        lengths[layout->panels[i].lane] += PANEL_SIZE(layout);
+
+    return ESP_OK;
+}
+
+// number of the first LED of the panel in its lane chain
+static size_t chain_start(const layout_t *layout, const layout_panel_t *panel)
+{
+    size_t res = 0;
+    for (size_t i = 0; i < NUM_PANELS(layout); i++)
+        if (layout->panels[i].lane == panel->lane && layout->panels[i].position < panel->position)
+            res += PANEL_SIZE(layout);
+
+    return res;
+}
+
+// number of LED inside the panel for pixel (x, y) of the panel area
+static size_t panel_index(const layout_t *layout, const layout_panel_t *panel, size_t x, size_t y)
+{
+    size_t w = layout->panel_width;
+    size_t h = layout->panel_height;
+
+    if (panel->flip)
+        x = w - x - 1;
+
+    // coordinates and width in panel's own orientation
+    size_t u, v, pw;
+    switch (panel->rotation)
+    {
+        case LAYOUT_ROTATE_90:
+            u = y;
+            v = w - x - 1;
+            pw = h;
+            break;
+        case LAYOUT_ROTATE_180:
+            u = w - x - 1;
+            v = h - y - 1;
+            pw = w;
+            break;
+        case LAYOUT_ROTATE_270:
+            u = h - y - 1;
+            v = x;
+            pw = h;
+            break;
+        default:
+            u = x;
+            v = y;
+            pw = w;
+    }
+
+    if (panel->wiring == LAYOUT_WIRING_SERPENTINE && v % 2)
+        u = pw - u - 1;
+
+    return v * pw + u;
+}
+
+esp_err_t layout_compile(const layout_t *layout, const size_t *offsets, size_t led_size, uint32_t *map)
+{
+    CHECK_ARG(layout && layout->panels && offsets && led_size && map);
+
+    size_t width = layout->cols * layout->panel_width;
+
+    for (size_t row = 0; row < layout->rows; row++)
+        for (size_t col = 0; col < layout->cols; col++)
+        {
+            const layout_panel_t *panel = &layout->panels[row * layout->cols + col];
+            size_t start = offsets[panel->lane] + chain_start(layout, panel) * led_size;
+
+            for (size_t y = 0; y < layout->panel_height; y++)
+                for (size_t x = 0; x < layout->panel_width; x++)
+                {
+                    size_t fb_x = col * layout->panel_width + x;
+                    size_t fb_y = row * layout->panel_height + y;
+                    map[fb_y * width + fb_x] = start + panel_index(layout, panel, x, y) * led_size;
+                }
+        }
+
+    return ESP_OK;
+}
@@ -0,0 +1,117 @@
+/**
+ * @file layout.h
+ *
+ * @defgroup led_output_layout led_output_layout
+ * @{
+ *
+ * Physical layout of LEDs: grid of panels
+ *
+ * Framebuffer is covered by a grid of equally sized panels. Each panel has
+ * its own orientation and wiring and is connected to some lane at some
+ * position in the chain of panels of that lane.
+ *
+ * Layout is compiled once into a flat table: framebuffer offset -> byte
+ * offset of the LED in frame buffer, so output stage does no per-pixel
+ * arithmetic. Description and compiler don't depend on ESP-IDF drivers,
+ * so the same layout can be compiled and verified on a host.
+ */
+#ifndef __LED_OUTPUT_LAYOUT_H__
+#define __LED_OUTPUT_LAYOUT_H__
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <esp_err.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Clockwise rotation of the panel
+ */
+typedef enum {
+    LAYOUT_ROTATE_0 = 0,
+    LAYOUT_ROTATE_90,
+    LAYOUT_ROTATE_180,
+    LAYOUT_ROTATE_270,
+} layout_rotation_t;
+
+/**
+ * Wiring of LEDs inside the panel, in panel's own coordinates: first LED
+ * is in the top left corner, first row goes from left to right.
+ */
+typedef enum {
+    LAYOUT_WIRING_SERPENTINE = 0, ///< Odd rows go from right to left
+    LAYOUT_WIRING_PROGRESSIVE,    ///< All rows go from left to right
+} layout_wiring_t;
+
+/**
+ * Panel description
+ */
+typedef struct
+{
+    layout_rotation_t rotation; ///< Rotation of the panel
+    bool flip;                  ///< Mirror rotated panel horizontally
+    layout_wiring_t wiring;     ///< Wiring of LEDs inside the panel
+    size_t lane;                ///< Lane the panel is connected to
+    size_t position;            ///< Position of the panel in the lane chain, 0 is the first
+} layout_panel_t;
+
+/**
+ * Layout description
+ */
+typedef struct
+{
+    size_t panel_width;           ///< Panel width in framebuffer pixels
+    size_t panel_height;          ///< Panel height in framebuffer pixels
+    size_t cols;                  ///< Number of panels in a row
+    size_t rows;                  ///< Number of rows of panels
+    const layout_panel_t *panels; ///< cols * rows panels, row by row from the top left one
+} layout_t;
+
+/**
+ * @brief Check layout description
+ *
+ * Every panel must be connected to an existing lane and positions of panels
+ * in every lane chain must be unique. Valid layout maps framebuffer to LEDs
+ * one to one.
+ *
+ * @param layout Layout
+ * @param num_lanes Number of lanes
+ * @return `ESP_OK` if layout is valid
+ */
+esp_err_t layout_check(const layout_t *layout, size_t num_lanes);
+
+/**
+ * @brief Get number of LEDs in every lane
+ *
+ * @param layout Layout
+ * @param num_lanes Number of lanes
+ * @param[out] lengths Number of LEDs, `num_lanes` items
+ * @return `ESP_OK` on success
+ */
+esp_err_t layout_get_lengths(const layout_t *layout, size_t num_lanes, size_t *lengths);
+
+/**
+ * @brief Compile layout into index table
+ *
+ * `map[y * width + x]` is set to `offsets[lane] + index * led_size`,
+ * where `index` is the number of the LED in its lane chain.
+ * Use `led_size = 1` and zero offsets to get plain LED indices.
+ *
+ * @param layout Valid layout
+ * @param offsets Byte offset of every lane
+ * @param led_size Bytes per LED
+ * @param[out] map Index table, `cols * panel_width * rows * panel_height` items
+ * @return `ESP_OK` on success
+ */
+esp_err_t layout_compile(const layout_t *layout, const size_t *offsets, size_t led_size, uint32_t *map);
+
+#ifdef __cplusplus
+}
+#endif
+
+/**@}*/
+
+#endif /* __LED_OUTPUT_LAYOUT_H__ */
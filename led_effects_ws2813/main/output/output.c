@@ -0,0 +1,365 @@
+/**
+ * @file output.c
+ *
+ * Output stage: framebuffer to LED strips
+ */
+#include <lib8tion.h>
+#include <esp_heap_caps.h>
+#include <math.h>
+#include <stdlib.h>
+
+#include "output/output.h"
+
+#define CHECK(x) do { esp_err_t __; if ((__ = x) != ESP_OK) return __; } while (0)
+#define CHECK_ARG(VAL) do { if (!(VAL)) return ESP_ERR_INVALID_ARG; } while (0)
+
+static esp_err_t update_tables(output_t *out)
+{
+    CHECK_ARG(out->gamma > 0);
+
+    const uint8_t white[3] = { out->white.r, out->white.g, out->white.b };
+
+    for (size_t i = 0; i < 256; i++)
+    {
+        uint8_t v = (uint8_t)(powf(i / 255.0f, out->gamma) * 255.0f + 0.5f);
+        for (size_t c = 0; c < 3; c++)
+        {
+            // same as rgb_scale_video() for linear gamma and no white balance
+            out->lut[c][i] = scale8_video((v * (white[c] + 1)) >> 8, out->brightness);
+            // corrected and encoded in a single lookup
+            if (out->backend->encoding)
+                out->words[c][i] = out->backend->encoding[out->lut[c][i]];
+        }
+    }
+
+    return ESP_OK;
+}
+
+static esp_err_t update_budget(output_t *out)
+{
+    CHECK_ARG(out->channel_current);
+
+    if (!out->max_current)
+    {
+        out->budget = 0;
+        return ESP_OK;
+    }
+
+    // LEDs draw idle current even when black
+    uint64_t idle = (uint64_t)out->idle_current * out->width * out->height;
+    uint64_t max = (uint64_t)out->max_current * 1000;
+    CHECK_ARG(max > idle);
+
+    out->budget = (max - idle) / out->channel_current;
+    if (!out->budget)
+        out->budget = 1;
+
+    return ESP_OK;
+}
+
+static uint32_t estimate_current(const output_t *out, uint32_t sum)
+{
+    uint64_t idle = (uint64_t)out->idle_current * out->width * out->height;
+    return (uint32_t)(((uint64_t)sum * out->channel_current + idle) / 1000);
+}
+
+esp_err_t output_init(output_t *out, const output_config_t *config)
+{
+    CHECK_ARG(out && config && config->backend && config->layout);
+    CHECK_ARG(config->num_lanes && config->num_lanes <= OUTPUT_MAX_LANES);
+
+    const layout_t *layout = config->layout;
+    size_t lengths[OUTPUT_MAX_LANES];
+    CHECK(layout_get_lengths(layout, config->num_lanes, lengths));
+
+    out->backend = config->backend;
+    out->width = layout->cols * layout->panel_width;
+    out->height = layout->rows * layout->panel_height;
+    out->num_lanes = config->num_lanes;
+    out->led_size = OUTPUT_COLOR_SIZE * (config->backend->encoding ? sizeof(uint32_t) : 1);
+    out->size = out->width * out->height * out->led_size;
+    out->map = NULL;
+    out->front = NULL;
+    out->back = NULL;
+    out->dirty = false;
+    out->flushed = 0;
+    out->skipped = 0;
+    out->brightness = config->brightness;
+    out->gamma = config->gamma;
+    out->white = config->white;
+    out->max_current = config->max_current;
+    out->channel_current = config->channel_current;
+    out->idle_current = config->idle_current;
+    out->budget = 0;
+    out->current = 0;
+    out->limited = 0;
+
+    CHECK(update_budget(out));
+
+    // lanes follow each other in frame buffer
+    size_t offsets[OUTPUT_MAX_LANES];
+    size_t offset = 0;
+    for (size_t l = 0; l < out->num_lanes; l++)
+    {
+        out->lanes[l].num = config->first_lane + l;
+        out->lanes[l].gpio = config->gpio[l];
+        out->lanes[l].length = lengths[l];
+        out->lanes[l].offset = offsets[l] = offset;
+        out->lanes[l].ctx = NULL;
+        offset += lengths[l] * out->led_size;
+    }
+
+    out->map = calloc(out->width * out->height, sizeof(uint32_t));
+    uint32_t caps = MALLOC_CAP_8BIT | (config->backend->dma ? MALLOC_CAP_DMA : 0);
+    out->front = heap_caps_calloc(out->size, 1, caps);
+    out->back = heap_caps_calloc(out->size, 1, caps);
+    if (!out->map || !out->front || !out->back)
+    {
+        output_free(out);
+        return ESP_ERR_NO_MEM;
+    }
+
+    layout_compile(layout, offsets, out->led_size, out->map);
+
+    for (size_t l = 0; l < out->num_lanes; l++)
+    {
+        if (!out->lanes[l].length)
+            continue;
+        esp_err_t res = out->backend->init(&out->lanes[l]);
+        if (res != ESP_OK)
+        {
+            output_free(out);
+            return res;
+        }
+    }
+
+    esp_err_t res = update_tables(out);
+    if (res != ESP_OK)
+        output_free(out);
+
+    return res;
+}
+
+esp_err_t output_free(output_t *out)
+{
+    CHECK_ARG(out);
+
+    for (size_t l = 0; l < out->num_lanes; l++)
+        if (out->lanes[l].ctx)
+            out->backend->free(&out->lanes[l]);
+
+    if (out->map)
+        free(out->map);
+    out->map = NULL;
+
+    if (out->front)
+        free(out->front);
+    out->front = NULL;
+
+    if (out->back)
+        free(out->back);
+    out->back = NULL;
+
+    return ESP_OK;
+}
+
+size_t output_get_memory(const output_t *out)
+{
+    if (!out)
+        return 0;
+
+    return sizeof(output_t) + out->size * 2 + out->width * out->height * sizeof(uint32_t);
+}
+
+esp_err_t output_set_brightness(output_t *out, uint8_t brightness)
+{
+    CHECK_ARG(out);
+
+    out->brightness = brightness;
+
+    return update_tables(out);
+}
+
+esp_err_t output_set_gamma(output_t *out, float gamma)
+{
+    CHECK_ARG(out && gamma > 0);
+
+    out->gamma = gamma;
+
+    return update_tables(out);
+}
+
+esp_err_t output_set_white_point(output_t *out, rgb_t white)
+{
+    CHECK_ARG(out);
+
+    out->white = white;
+
+    return update_tables(out);
+}
+
+esp_err_t output_set_current_limit(output_t *out, uint32_t max_current)
+{
+    CHECK_ARG(out);
+
+    uint32_t prev = out->max_current;
+    out->max_current = max_current;
+    esp_err_t res = update_budget(out);
+    if (res != ESP_OK)
+    {
+        out->max_current = prev;
+        update_budget(out);
+    }
+
+    return res;
+}
+
+/**
+ * Write frame again with every corrected channel value scaled by `scale / 256`.
+ * Only frames over current budget get here, so it may be slow.
+ */
+static uint32_t write_limited(output_t *out, const rgb_t *src, size_t count, uint8_t scale)
+{
+    const uint32_t *map = out->map;
+    const uint32_t *encoding = out->backend->encoding;
+    uint8_t *buf = out->back;
+    const uint8_t *prev = out->front;
+    uint32_t sum = 0;
+    uint32_t diff = 0;
+
+    for (size_t i = 0; i < count; i++)
+    {
+        // GRB
+        uint8_t v[OUTPUT_COLOR_SIZE] = {
+            scale8(out->lut[1][src[i].g], scale),
+            scale8(out->lut[0][src[i].r], scale),
+            scale8(out->lut[2][src[i].b], scale),
+        };
+        sum += v[0] + v[1] + v[2];
+
+        uint32_t offs = map[i];
+        for (size_t c = 0; c < OUTPUT_COLOR_SIZE; c++)
+        {
+            if (encoding)
+            {
+                uint32_t *dst = (uint32_t *)(buf + offs);
+                dst[c] = encoding[v[c]];
+                diff |= dst[c] ^ ((const uint32_t *)(prev + offs))[c];
+            }
+            else
+            {
+                buf[offs + c] = v[c];
+                diff |= v[c] ^ prev[offs + c];
+            }
+        }
+    }
+    out->dirty = diff != 0;
+
+    return sum;
+}
+
+static void limit_current(output_t *out, const rgb_t *src, size_t count, uint32_t sum)
+{
+    if (out->budget && sum > out->budget)
+    {
+        // global factor, brings frame just under budget
+        uint8_t scale = ((uint64_t)out->budget << 8) / sum;
+        sum = write_limited(out, src, count, scale);
+        out->limited++;
+    }
+    out->current = estimate_current(out, sum);
+}
+
+esp_err_t output_write(output_t *out, framebuffer_t *fb)
+{
+    CHECK_ARG(out && fb && out->map && out->back && fb->width == out->width && fb->height == out->height);
+
+    const rgb_t *src = fb->data;
+    const uint32_t *map = out->map;
+    const uint8_t *lut_r = out->lut[0];
+    const uint8_t *lut_g = out->lut[1];
+    const uint8_t *lut_b = out->lut[2];
+    uint8_t *buf = out->back;
+    const uint8_t *prev = out->front;
+    size_t count = fb->width * fb->height;
+
+    if (out->backend->encoding)
+    {
+        const uint32_t *words_r = out->words[0];
+        const uint32_t *words_g = out->words[1];
+        const uint32_t *words_b = out->words[2];
+        uint32_t diff = 0;
+        uint32_t sum = 0;
+        for (size_t i = 0; i < count; i++)
+        {
+            uint32_t offs = map[i];
+            uint32_t *dst = (uint32_t *)(buf + offs);
+            const uint32_t *old = (const uint32_t *)(prev + offs);
+            // GRB
+            dst[0] = words_g[src[i].g];
+            dst[1] = words_r[src[i].r];
+            dst[2] = words_b[src[i].b];
+            // compare with transmitted frame
+            diff |= (dst[0] ^ old[0]) | (dst[1] ^ old[1]) | (dst[2] ^ old[2]);
+            // current model
+            sum += lut_g[src[i].g] + lut_r[src[i].r] + lut_b[src[i].b];
+        }
+        out->dirty = diff != 0;
+        limit_current(out, src, count, sum);
+
+        return ESP_OK;
+    }
+
+    uint8_t diff = 0;
+    uint32_t sum = 0;
+    for (size_t i = 0; i < count; i++)
+    {
+        uint32_t offs = map[i];
+        uint8_t *dst = buf + offs;
+        const uint8_t *old = prev + offs;
+        // GRB
+        dst[0] = lut_g[src[i].g];
+        dst[1] = lut_r[src[i].r];
+        dst[2] = lut_b[src[i].b];
+        // compare with transmitted frame
+        diff |= (dst[0] ^ old[0]) | (dst[1] ^ old[1]) | (dst[2] ^ old[2]);
+        // current model
+        sum += dst[0] + dst[1] + dst[2];
+    }
+    out->dirty = diff != 0;
+    limit_current(out, src, count, sum);
+
+    return ESP_OK;
+}
+
+esp_err_t output_render(framebuffer_t *fb, void *arg)
+{
+    CHECK_ARG(fb && arg);
+
+    output_t *out = (output_t *)arg;
+    CHECK(output_write(out, fb));
+
+    // strips already show this frame
+    if (!out->dirty)
+    {
+        out->skipped++;
+        return ESP_OK;
+    }
+    out->flushed++;
+
+    // each lane waits for its previous frame only, so all lanes
+    // are transmitted concurrently in background
+    for (size_t l = 0; l < out->num_lanes; l++)
+    {
+        output_lane_t *lane = &out->lanes[l];
+        if (lane->length)
+            CHECK(out->backend->flush(lane, out->back + lane->offset, lane->length * out->led_size));
+    }
+
+    // swap buffers, old front is not transmitted anymore
+    uint8_t *front = out->front;
+    out->front = out->back;
+    out->back = front;
+
+    return ESP_OK;
+}
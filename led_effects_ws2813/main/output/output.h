@@ -0,0 +1,240 @@
+/**
+ * @file output.h
+ *
+ * @defgroup led_output led_output
+ * @{
+ *
+ * Output stage: framebuffer to LED strips
+ *
+ * Framebuffer is split across one or more lanes, each lane is a separate
+ * LED strip on its own GPIO driven by an output backend. All lanes are
+ * transmitted concurrently. Backends that need encoded data get it written
+ * straight into frame buffer in the same pass.
+ *
+ * Layout of panels is compiled into framebuffer-to-lane index map once
+ * in output_init(), so a frame
+ * is written into the strip buffer in a single linear pass with color
+ * correction already applied: gamma, white balance and brightness are
+ * combined into three per-channel lookup tables, rebuilt whenever any of
+ * them changes.
+ *
+ * Strip buffer is double buffered: a new frame is written into the back
+ * buffer while the backend still transmits the front one, buffers
+ * are swapped on flush.
+ *
+ * New frame is compared with the last transmitted one while it is written,
+ * flush is skipped when nothing has changed.
+ *
+ * Current drawn by LEDs is estimated in the same pass: corrected channel
+ * values are summed and multiplied by calibrated current per unit. Frame
+ * exceeding current budget is written once more scaled down by a single
+ * global factor, so its colors are kept.
+ */
+#ifndef __LED_OUTPUT_H__
+#define __LED_OUTPUT_H__
+
+#include <framebuffer.h>
+
+#include "output/layout.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define OUTPUT_MAX_LANES 4
+
+#define OUTPUT_COLOR_SIZE 3 ///< Bytes per LED, GRB order
+
+/**
+ * LED strip connected to a single GPIO
+ */
+typedef struct
+{
+    size_t num;     ///< Lane number, unique across outputs
+    int gpio;       ///< GPIO number
+    size_t length;  ///< Number of LEDs
+    size_t offset;  ///< Byte offset of lane data in frame buffer
+    void *ctx;      ///< Backend state
+} output_lane_t;
+
+/**
+ * Output backend, transmits lane data to LEDs
+ */
+typedef struct
+{
+    /**
+     * Setup lane hardware
+     */
+    esp_err_t (*init)(output_lane_t *lane);
+    /**
+     * Release lane hardware
+     */
+    esp_err_t (*free)(output_lane_t *lane);
+    /**
+     * Wait for the previous transmission to complete and start
+     * transmitting `size` bytes of `data`, don't wait for it.
+     * `data` stays valid until the next flush of the lane.
+     */
+    esp_err_t (*flush)(output_lane_t *lane, const uint8_t *data, size_t size);
+    /**
+     * Optional encoding table. If set, every color byte is written into
+     * frame buffer as 32-bit word `encoding[byte]`, ready to be transmitted.
+     * Table must be filled when init() returns.
+     */
+    const uint32_t *encoding;
+    /**
+     * Frame buffers must be allocated in DMA capable memory
+     */
+    bool dma;
+} output_backend_t;
+
+/**
+ * Output stage configuration
+ */
+typedef struct
+{
+    const output_backend_t *backend; ///< Output backend
+    const layout_t *layout;          ///< Layout of panels, defines framebuffer size
+    uint8_t brightness;              ///< Brightness, 0..255
+    float gamma;                     ///< Gamma, 1.0 for linear output
+    rgb_t white;                     ///< White point, 255/255/255 for no correction
+    uint32_t max_current;            ///< Current budget, mA, 0 for no limit
+    uint32_t channel_current;        ///< Current per channel unit (1/255 of full color channel), uA
+    uint32_t idle_current;           ///< Current of a single black LED, uA
+    size_t num_lanes;                ///< Number of lanes, 1..OUTPUT_MAX_LANES
+    size_t first_lane;               ///< Number of the first lane, outputs sharing a backend must not overlap
+    int gpio[OUTPUT_MAX_LANES];      ///< GPIO number of each lane
+} output_config_t;
+
+/**
+ * Output stage descriptor
+ */
+typedef struct
+{
+    const output_backend_t *backend;
+    size_t width;                         ///< Framebuffer width
+    size_t height;                        ///< Framebuffer height
+    size_t num_lanes;                     ///< Number of lanes
+    output_lane_t lanes[OUTPUT_MAX_LANES];
+    size_t led_size;                      ///< Bytes per LED in frame buffer
+    size_t size;                          ///< Frame size in bytes, all lanes
+    uint32_t *map;                        ///< Framebuffer offset -> byte offset in frame buffer
+    uint8_t *front;                       ///< Transmitted frame
+    uint8_t *back;                        ///< Frame being written, swapped with front on flush
+    uint8_t brightness;                   ///< Brightness, 0..255
+    float gamma;                          ///< Gamma
+    rgb_t white;                          ///< White point
+    uint8_t lut[3][256];                  ///< Color correction tables, R, G, B
+    uint32_t words[3][256];               ///< Color correction and backend encoding tables, R, G, B
+    uint32_t max_current;                 ///< Current budget, mA, 0 for no limit
+    uint32_t channel_current;             ///< Current per channel unit, uA
+    uint32_t idle_current;                ///< Current of a single black LED, uA
+    uint32_t budget;                      ///< Current budget in channel units, 0 for no limit
+    uint32_t current;                     ///< Estimated current of the last written frame, mA
+    uint32_t limited;                     ///< Number of frames scaled down by current limiter
+    bool dirty;                           ///< Last written frame differs from the transmitted one
+    uint32_t flushed;                     ///< Number of flushed frames
+    uint32_t skipped;                     ///< Number of frames skipped as unchanged
+} output_t;
+
+/**
+ * @brief Compile layout and build color correction tables, setup lanes
+ *
+ * @param out Output descriptor
+ * @param config Output configuration
+ * @return `ESP_OK` on success
+ */
+esp_err_t output_init(output_t *out, const output_config_t *config);
+
+/**
+ * @brief Free resources allocated by output_init()
+ *
+ * @param out Output descriptor
+ * @return `ESP_OK` on success
+ */
+esp_err_t output_free(output_t *out);
+
+/**
+ * @brief Get memory allocated by the output stage
+ *
+ * Frame buffers, index map and the descriptor itself. Backends allocate
+ * only a few bytes per lane.
+ *
+ * @param out Output descriptor
+ * @return Number of bytes
+ */
+size_t output_get_memory(const output_t *out);
+
+/**
+ * @brief Set brightness and rebuild color correction tables
+ *
+ * @param out Output descriptor
+ * @param brightness Brightness, 0..255
+ * @return `ESP_OK` on success
+ */
+esp_err_t output_set_brightness(output_t *out, uint8_t brightness);
+
+/**
+ * @brief Set gamma and rebuild color correction tables
+ *
+ * @param out Output descriptor
+ * @param gamma Gamma, 1.0 for linear output
+ * @return `ESP_OK` on success
+ */
+esp_err_t output_set_gamma(output_t *out, float gamma);
+
+/**
+ * @brief Set white point and rebuild color correction tables
+ *
+ * Every channel is scaled by `white.<channel> / 255`.
+ *
+ * @param out Output descriptor
+ * @param white White point
+ * @return `ESP_OK` on success
+ */
+esp_err_t output_set_white_point(output_t *out, rgb_t white);
+
+/**
+ * @brief Set current budget
+ *
+ * @param out Output descriptor
+ * @param max_current Current budget, mA, 0 for no limit. Must be greater
+ *                    than idle current of all LEDs
+ * @return `ESP_OK` on success
+ */
+esp_err_t output_set_current_limit(output_t *out, uint32_t max_current);
+
+/**
+ * @brief Write framebuffer into back buffer without flushing it
+ *
+ * Sets `dirty` flag if written frame differs from the transmitted one.
+ * Estimates current of the frame and scales frame down if it exceeds
+ * current budget.
+ *
+ * @param out Output descriptor
+ * @param fb Framebuffer
+ * @return `ESP_OK` on success
+ */
+esp_err_t output_write(output_t *out, framebuffer_t *fb);
+
+/**
+ * @brief Framebuffer render callback
+ *
+ * Writes framebuffer with output_write(), flushes all lanes and swaps
+ * buffers. Waits only for transmission of the previous frame to complete.
+ * Unchanged frames are not flushed.
+ * Pass it to fb_init() and pass output descriptor as render context.
+ *
+ * @param fb Framebuffer
+ * @param arg Output descriptor
+ * @return `ESP_OK` on success
+ */
+esp_err_t output_render(framebuffer_t *fb, void *arg);
+
+#ifdef __cplusplus
+}
+#endif
+
+/**@}*/
+
+#endif /* __LED_OUTPUT_H__ */
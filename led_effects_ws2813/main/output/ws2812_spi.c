@@ -0,0 +1,29 @@
+/**
+ * @file ws2812_spi.c
+ *
+ * WS2812/WS2813 bit encoding for SPI
+ */
+#include "output/ws2812_spi.h"
+
+uint32_t ws2812_spi_encode(uint8_t value)
+{
+    uint32_t res = 0;
+    for (int bit = 7; bit >= 0; bit--)
+        res = (res << 4) | (value & (1 << bit) ? WS2812_SPI_BIT_1 : WS2812_SPI_BIT_0);
+
+    return res;
+}
+
+void ws2812_spi_encoding_init(uint32_t table[256])
+{
+    for (int i = 0; i < 256; i++)
+    {
+        uint32_t word = ws2812_spi_encode(i);
+        // SPI sends memory byte by byte, MSB first
+        uint8_t *bytes = (uint8_t *)&table[i];
+        bytes[0] = word >> 24;
+        bytes[1] = word >> 16;
+        bytes[2] = word >> 8;
+        bytes[3] = word;
+    }
+}
@@ -0,0 +1,55 @@
+/**
+ * @file ws2812_spi.h
+ *
+ * @defgroup led_output_ws2812_spi led_output_ws2812_spi
+ * @{
+ *
+ * WS2812/WS2813 bit encoding for SPI
+ *
+ * Every WS2812 bit is sent as 4 SPI bits at 3.2 MHz, 312.5 ns per SPI bit:
+ *   - 0: 1000, 312.5 ns high, 937.5 ns low
+ *   - 1: 1110, 937.5 ns high, 312.5 ns low
+ *
+ * So every color byte becomes a 32-bit word. Encoding table has no
+ * dependencies on ESP-IDF, so it can be checked against reference bit
+ * patterns on any host.
+ */
+#ifndef __LED_OUTPUT_WS2812_SPI_H__
+#define __LED_OUTPUT_WS2812_SPI_H__
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define WS2812_SPI_CLOCK_HZ 3200000
+
+#define WS2812_SPI_BIT_0 0x8 ///< 1000
+#define WS2812_SPI_BIT_1 0xe ///< 1110
+
+/**
+ * @brief Encode single color byte
+ *
+ * @param value Color byte
+ * @return SPI word, MSB is transmitted first
+ */
+uint32_t ws2812_spi_encode(uint8_t value);
+
+/**
+ * @brief Fill encoding table
+ *
+ * Words are stored in memory in transmission order, so they can be
+ * written into SPI DMA buffer as is.
+ *
+ * @param table Table of 256 words, indexed by color byte
+ */
+void ws2812_spi_encoding_init(uint32_t table[256]);
+
+#ifdef __cplusplus
+}
+#endif
+
+/**@}*/
+
+#endif /* __LED_OUTPUT_WS2812_SPI_H__ */
@@ -0,0 +1,44 @@
+/**
+ * @file blend.c
+ *
+ * Fixed-point blending of two frames
+ */
+#include "player/blend.h"
+
+#define EVEN_BYTES 0x00ff00ffu
+
+static inline uint8_t blend_byte(uint8_t a, uint8_t b, uint32_t wa, uint32_t wb)
+{
+    return (a * wa + b * wb) >> 8;
+}
+
+void blend_rgb(rgb_t *dst, const rgb_t *a, const rgb_t *b, size_t count, uint8_t alpha)
+{
+    // weights add up to 256, so a lane never overflows 16 bits
+    uint32_t wb = alpha;
+    uint32_t wa = 256 - wb;
+    uint8_t *d = (uint8_t *)dst;
+    const uint8_t *pa = (const uint8_t *)a;
+    const uint8_t *pb = (const uint8_t *)b;
+    size_t size = count * sizeof(rgb_t);
+    size_t i = 0;
+
+    // framebuffers are word aligned, any others take the byte path
+    if (!(((uintptr_t)d | (uintptr_t)pa | (uintptr_t)pb) & 3))
+    {
+        uint32_t *wd = (uint32_t *)d;
+        const uint32_t *wpa = (const uint32_t *)pa;
+        const uint32_t *wpb = (const uint32_t *)pb;
+        for (; i + 4 <= size; i += 4)
+        {
+            uint32_t va = *wpa++;
+            uint32_t vb = *wpb++;
+            uint32_t even = ((va & EVEN_BYTES) * wa + (vb & EVEN_BYTES) * wb) >> 8;
+            uint32_t odd = ((va >> 8) & EVEN_BYTES) * wa + ((vb >> 8) & EVEN_BYTES) * wb;
+            *wd++ = (even & EVEN_BYTES) | (odd & ~EVEN_BYTES);
+        }
+    }
+
+    for (; i < size; i++)
+        d[i] = blend_byte(pa[i], pb[i], wa, wb);
+}
@@ -0,0 +1,50 @@
+/**
+ * @file blend.h
+ *
+ * @defgroup led_blend led_blend
+ * @{
+ *
+ * Fixed-point blending of two frames
+ *
+ * Every color byte is mixed as `(a * (256 - alpha) + b * alpha) / 256`,
+ * a 32-bit word of four bytes at a time: even and odd bytes are weighted
+ * in two 16-bit lanes, so every multiplication weights two bytes and a
+ * word takes four of them. A pixel takes a few cycles and no division.
+ * No dependencies on ESP-IDF.
+ */
+#ifndef __LED_BLEND_H__
+#define __LED_BLEND_H__
+
+#include <stddef.h>
+#include <stdint.h>
+#include <color.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Estimated CPU cycles per pixel of blend_rgb()
+ */
+#define BLEND_CYCLES_PER_PIXEL 10
+
+/**
+ * @brief Blend two frames
+ *
+ * `dst` may be the same as `a` or `b`.
+ *
+ * @param dst Blended pixels
+ * @param a First frame, kept as is at `alpha` 0
+ * @param b Second frame, weighted by `alpha / 256`
+ * @param count Number of pixels
+ * @param alpha Weight of the second frame, 0..255
+ */
+void blend_rgb(rgb_t *dst, const rgb_t *a, const rgb_t *b, size_t count, uint8_t alpha);
+
+#ifdef __cplusplus
+}
+#endif
+
+/**@}*/
+
+#endif /* __LED_BLEND_H__ */
@@ -0,0 +1,44 @@
+/**
+ * @file command.c
+ *
+ * Single-producer single-consumer command queue
+ */
+#include "player/command.h"
+
+#define MASK (COMMAND_QUEUE_SIZE - 1)
+
+_Static_assert((COMMAND_QUEUE_SIZE & MASK) == 0, "COMMAND_QUEUE_SIZE must be a power of two");
+
+void command_queue_init(command_queue_t *queue)
+{
+    queue->head = 0;
+    queue->tail = 0;
+}
+
+bool command_queue_push(command_queue_t *queue, const command_t *cmd)
+{
+    uint32_t head = __atomic_load_n(&queue->head, __ATOMIC_RELAXED);
+    // slot is free once consumer has published it
+    uint32_t tail = __atomic_load_n(&queue->tail, __ATOMIC_ACQUIRE);
+    if (head - tail == COMMAND_QUEUE_SIZE)
+        return false;
+
+    queue->commands[head & MASK] = *cmd;
+    __atomic_store_n(&queue->head, head + 1, __ATOMIC_RELEASE);
+
+    return true;
+}
+
+bool command_queue_pop(command_queue_t *queue, command_t *cmd)
+{
+    uint32_t tail = __atomic_load_n(&queue->tail, __ATOMIC_RELAXED);
+    // command is complete once producer has published it
+    uint32_t head = __atomic_load_n(&queue->head, __ATOMIC_ACQUIRE);
+    if (head == tail)
+        return false;
+
+    *cmd = queue->commands[tail & MASK];
+    __atomic_store_n(&queue->tail, tail + 1, __ATOMIC_RELEASE);
+
+    return true;
+}
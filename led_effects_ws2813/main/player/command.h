@@ -0,0 +1,86 @@
+/**
+ * @file command.h
+ *
+ * @defgroup led_command led_command
+ * @{
+ *
+ * Single-producer single-consumer command queue
+ *
+ * Fixed-size ring of commands, no allocation and no locks: producer only
+ * writes `head`, consumer only writes `tail`, and each publishes its index
+ * with a release store after the command is copied. Only one task may push
+ * and only one may pop at a time. No dependencies on ESP-IDF.
+ */
+#ifndef __LED_COMMAND_H__
+#define __LED_COMMAND_H__
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <framebuffer.h>
+#include <fbanimation.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define COMMAND_QUEUE_SIZE 16 ///< Capacity of queue, power of two
+#define COMMAND_PARAMS     4  ///< Bytes of parameters in a command
+
+/**
+ * Command
+ */
+typedef struct
+{
+    uint32_t type;                   ///< Command type, defined by consumer
+    uint32_t value;                  ///< Argument
+    uint8_t params[COMMAND_PARAMS];  ///< Parameters
+    framebuffer_t *fb;               ///< Framebuffer argument
+    framebuffer_t *mix;              ///< Second framebuffer argument
+    fb_draw_cb_t draw;               ///< Draw function argument
+    int64_t sent;                    ///< Time command was pushed, us
+} command_t;
+
+/**
+ * Command queue
+ */
+typedef struct
+{
+    uint32_t head;                          ///< Commands pushed, written by producer
+    uint32_t tail;                          ///< Commands popped, written by consumer
+    command_t commands[COMMAND_QUEUE_SIZE]; ///< Ring of commands
+} command_queue_t;
+
+/**
+ * @brief Empty queue
+ *
+ * Neither producer nor consumer may use the queue meanwhile.
+ *
+ * @param queue Command queue
+ */
+void command_queue_init(command_queue_t *queue);
+
+/**
+ * @brief Push command, producer side
+ *
+ * @param queue Command queue
+ * @param cmd Command, copied
+ * @return false if queue is full
+ */
+bool command_queue_push(command_queue_t *queue, const command_t *cmd);
+
+/**
+ * @brief Pop the oldest command, consumer side
+ *
+ * @param queue Command queue
+ * @param[out] cmd Command
+ * @return false if queue is empty
+ */
+bool command_queue_pop(command_queue_t *queue, command_t *cmd);
+
+#ifdef __cplusplus
+}
+#endif
+
+/**@}*/
+
+#endif /* __LED_COMMAND_H__ */
@@ -0,0 +1,438 @@
+/**
+ * @file player.c
+ *
+ * Effect player with adaptive frame rate
+ */
+#include <freertos/FreeRTOS.h>
+
+#include "player/player.h"
+#include "player/blend.h"
+
+#ifdef CONFIG_EXAMPLE_PROFILE
+#include <esp_cpu.h>
+#endif
+
+#define CHECK(x) do { esp_err_t __; if ((__ = x) != ESP_OK) return __; } while (0)
+#define CHECK_ARG(VAL) do { if (!(VAL)) return ESP_ERR_INVALID_ARG; } while (0)
+
+#define US_PER_SEC 1000000
+
+// moving average, 1/8 of a new sample
+static uint32_t average(uint32_t avg, uint32_t sample, uint32_t frames)
+{
+    if (frames == 1)
+        return sample;
+
+    return (int32_t)avg + (((int32_t)sample - (int32_t)avg) >> 3);
+}
+
+// highest FPS keeping frame time at `load` percents of period
+static uint8_t fit_fps(const player_t *player, uint32_t frame_us, uint32_t load)
+{
+    if (!frame_us)
+        return player->max_fps;
+
+    uint32_t fps = US_PER_SEC / 100 * load / frame_us;
+
+    return fps < player->min_fps ? player->min_fps : fps > player->max_fps ? player->max_fps : fps;
+}
+
+static void adapt_fps(player_t *player, uint32_t frame_us)
+{
+    uint32_t period = US_PER_SEC / player->fps;
+    uint8_t fps = fit_fps(player, frame_us, PLAYER_LOAD_TARGET);
+
+    if (frame_us * 100 > period * PLAYER_LOAD_HIGH)
+    {
+        // too slow, drop at once
+        player->fps = fps;
+        player->stable = 0;
+    }
+    else if (fps > player->fps)
+    {
+        // fast enough for higher FPS for a second
+        if (++player->stable >= player->fps)
+        {
+            player->fps = fps;
+            player->stable = 0;
+        }
+    }
+    else
+        player->stable = 0;
+}
+
+// incoming effect takes over
+static void finish_crossfade(player_t *player)
+{
+    player->fb = player->next_fb;
+    player->draw = player->next_draw;
+    player->next_fb = NULL;
+    player->next_draw = NULL;
+}
+
+static void reset_stats(player_t *player)
+{
+    player->stats = (player_stats_t) { 0 };
+#ifdef CONFIG_EXAMPLE_PROFILE
+    profile_hist_reset(&player->compute);
+    profile_hist_reset(&player->blend);
+    profile_hist_reset(&player->output);
+#endif
+}
+
+static esp_err_t start_crossfade(player_t *player, framebuffer_t *fb, fb_draw_cb_t draw, framebuffer_t *mix,
+        uint32_t duration_ms)
+{
+    CHECK_ARG(fb && draw && mix && fb != player->fb && mix != player->fb && mix != fb);
+    CHECK_ARG(fb->width == player->fb->width && fb->height == player->fb->height);
+    CHECK_ARG(mix->width == fb->width && mix->height == fb->height);
+
+    if (player->next_fb)
+        finish_crossfade(player);
+
+    // next frame starts blending, FPS follows cost of both effects
+    player->next_fb = fb;
+    player->next_draw = draw;
+    player->mix = mix;
+    player->fade_start = esp_timer_get_time();
+    player->fade_us = duration_ms * 1000;
+    player->stable = 0;
+    reset_stats(player);
+
+    return ESP_OK;
+}
+
+// execute queued commands, return number of them and times they were sent
+static size_t execute_commands(player_t *player, int64_t *sent)
+{
+    command_t cmd;
+    size_t count = 0;
+
+    // commands sent meanwhile wait for the next frame
+    while (count < COMMAND_QUEUE_SIZE && command_queue_pop(&player->commands, &cmd))
+    {
+        switch (cmd.type)
+        {
+            case PLAYER_CMD_CROSSFADE:
+                start_crossfade(player, cmd.fb, cmd.draw, cmd.mix, cmd.value);
+                break;
+            case PLAYER_CMD_PAUSE:
+                player->paused = cmd.value != 0;
+                break;
+            case PLAYER_CMD_FINISH:
+                if (player->next_fb)
+                    finish_crossfade(player);
+                player->finished++;
+                xSemaphoreGive(player->finish);
+                break;
+            default:
+                if (player->handler)
+                    player->handler(&cmd, player->handler_ctx);
+        }
+        sent[count++] = cmd.sent;
+    }
+
+    return count;
+}
+
+// time from sending to the end of the first frame affected by command
+static void add_latencies(player_t *player, const int64_t *sent, size_t count, int64_t end)
+{
+    player_stats_t *stats = &player->stats;
+
+    for (size_t i = 0; i < count; i++)
+    {
+        uint32_t latency = end - sent[i];
+        stats->commands++;
+        stats->latency_us = average(stats->latency_us, latency, stats->commands);
+        if (latency > stats->max_latency_us)
+            stats->max_latency_us = latency;
+    }
+}
+
+// render a frame of playing player, set its next deadline, return end of the frame
+static int64_t render_frame(player_t *player)
+{
+    int64_t sent[COMMAND_QUEUE_SIZE];
+    size_t commands = execute_commands(player, sent);
+
+    int64_t start = esp_timer_get_time();
+    if (player->paused)
+    {
+        // nothing is drawn, commands are still taken every period
+        add_latencies(player, sent, commands, start);
+        player->deadline = start + US_PER_SEC / player->fps;
+        return start;
+    }
+
+    if (player->next_fb && start - player->fade_start >= player->fade_us)
+        finish_crossfade(player);
+
+#ifdef CONFIG_EXAMPLE_PROFILE
+    uint32_t c_start = esp_cpu_get_ccount();
+#endif
+    player->draw(player->fb);
+    if (player->next_fb)
+        player->next_draw(player->next_fb);
+#ifdef CONFIG_EXAMPLE_PROFILE
+    uint32_t c_drawn = esp_cpu_get_ccount();
+#endif
+    int64_t drawn = esp_timer_get_time();
+
+    framebuffer_t *fb = player->fb;
+    if (player->next_fb)
+    {
+        // elapsed time is below duration here, so alpha never reaches 256
+        uint8_t alpha = (uint64_t)(start - player->fade_start) * 256 / player->fade_us;
+        fb = player->mix;
+        blend_rgb(fb->data, player->fb->data, player->next_fb->data, fb->width * fb->height, alpha);
+    }
+#ifdef CONFIG_EXAMPLE_PROFILE
+    uint32_t c_blended = esp_cpu_get_ccount();
+#endif
+    int64_t blended = esp_timer_get_time();
+
+    fb_render(fb, player->render_ctx);
+    int64_t end = esp_timer_get_time();
+#ifdef CONFIG_EXAMPLE_PROFILE
+    profile_hist_add(&player->compute, c_drawn - c_start);
+    if (fb == player->mix)
+        profile_hist_add(&player->blend, c_blended - c_drawn);
+    profile_hist_add(&player->output, esp_cpu_get_ccount() - c_blended);
+#endif
+
+    player_stats_t *stats = &player->stats;
+    uint32_t frame_us = end - start;
+    stats->frames++;
+    stats->draw_us = average(stats->draw_us, drawn - start, stats->frames);
+    stats->render_us = average(stats->render_us, end - blended, stats->frames);
+    if (fb == player->mix)
+    {
+        stats->blended++;
+        stats->blend_us = average(stats->blend_us, blended - drawn, stats->blended);
+    }
+    if (frame_us > stats->max_us)
+        stats->max_us = frame_us;
+    add_latencies(player, sent, commands, end);
+    // kept across crossfades, so gaps caused by switching are seen too
+    if (player->last_end && end - player->last_end > stats->max_gap_us)
+        stats->max_gap_us = end - player->last_end;
+    player->last_end = end;
+
+    // late frames are not caught up, next period starts now
+    player->deadline += US_PER_SEC / player->fps;
+    if (end > player->deadline)
+    {
+        stats->missed++;
+        player->deadline = end;
+    }
+
+    adapt_fps(player, stats->draw_us + stats->render_us + (player->next_fb ? stats->blend_us : 0));
+
+    return end;
+}
+
+static void frame(void *arg)
+{
+    player_t *player = (player_t *)arg;
+
+    xSemaphoreTake(player->mutex, portMAX_DELAY);
+    if (player->playing)
+    {
+        int64_t end = render_frame(player);
+        esp_timer_start_once(player->timer, player->deadline - end);
+    }
+    xSemaphoreGive(player->mutex);
+}
+
+esp_err_t player_init_scheduled(player_t *player, framebuffer_t *fb, uint8_t min_fps, uint8_t max_fps)
+{
+    CHECK_ARG(player && fb && min_fps && min_fps <= max_fps);
+
+    player->fb = fb;
+    player->timer = NULL;
+    player->draw = NULL;
+    player->render_ctx = NULL;
+    player->next_fb = NULL;
+    player->next_draw = NULL;
+    player->mix = NULL;
+    player->playing = false;
+    player->paused = false;
+    player->last_end = 0;
+    player->handler = NULL;
+    player->handler_ctx = NULL;
+    command_queue_init(&player->commands);
+    player->min_fps = min_fps;
+    player->max_fps = max_fps;
+    player->fps = max_fps;
+    player->stable = 0;
+    player->finished = 0;
+    player->finish_sent = 0;
+
+    player->mutex = xSemaphoreCreateMutex();
+    player->finish = xSemaphoreCreateBinary();
+    if (!player->mutex || !player->finish)
+    {
+        if (player->mutex)
+            vSemaphoreDelete(player->mutex);
+        if (player->finish)
+            vSemaphoreDelete(player->finish);
+        return ESP_ERR_NO_MEM;
+    }
+
+    return ESP_OK;
+}
+
+esp_err_t player_init(player_t *player, framebuffer_t *fb, uint8_t min_fps, uint8_t max_fps)
+{
+    CHECK(player_init_scheduled(player, fb, min_fps, max_fps));
+
+    esp_timer_create_args_t args = {
+        .callback = frame,
+        .arg = player,
+        .dispatch_method = ESP_TIMER_TASK,
+        .name = "player",
+    };
+    esp_err_t res = esp_timer_create(&args, &player->timer);
+    if (res != ESP_OK)
+    {
+        vSemaphoreDelete(player->mutex);
+        vSemaphoreDelete(player->finish);
+    }
+
+    return res;
+}
+
+esp_err_t player_free(player_t *player)
+{
+    CHECK_ARG(player);
+
+    CHECK(player_stop(player));
+    if (player->timer)
+        CHECK(esp_timer_delete(player->timer));
+    vSemaphoreDelete(player->mutex);
+    vSemaphoreDelete(player->finish);
+
+    return ESP_OK;
+}
+
+esp_err_t player_play(player_t *player, fb_draw_cb_t draw, void *render_ctx)
+{
+    CHECK_ARG(player && draw);
+
+    CHECK(player_stop(player));
+
+    xSemaphoreTake(player->mutex, portMAX_DELAY);
+    if (player->next_fb)
+        finish_crossfade(player);
+    player->draw = draw;
+    player->render_ctx = render_ctx;
+    player->fps = player->max_fps;
+    player->stable = 0;
+    reset_stats(player);
+    player->deadline = esp_timer_get_time();
+    player->last_end = 0;
+    player->playing = true;
+    esp_err_t res = player->timer ? esp_timer_start_once(player->timer, 0) : ESP_OK;
+    xSemaphoreGive(player->mutex);
+
+    return res;
+}
+
+esp_err_t player_stop(player_t *player)
+{
+    CHECK_ARG(player);
+
+    // frame in progress either finishes before this or sees the flag
+    xSemaphoreTake(player->mutex, portMAX_DELAY);
+    player->playing = false;
+    if (player->timer)
+        esp_timer_stop(player->timer);
+    xSemaphoreGive(player->mutex);
+    // nothing will be finished, don't keep player_finish_crossfade() waiting
+    xSemaphoreGive(player->finish);
+
+    return ESP_OK;
+}
+
+esp_err_t player_frame(player_t *player, int64_t *deadline)
+{
+    CHECK_ARG(player && deadline);
+
+    xSemaphoreTake(player->mutex, portMAX_DELAY);
+    esp_err_t res = ESP_ERR_INVALID_STATE;
+    if (player->playing)
+    {
+        render_frame(player);
+        *deadline = player->deadline;
+        res = ESP_OK;
+    }
+    xSemaphoreGive(player->mutex);
+
+    return res;
+}
+
+esp_err_t player_crossfade(player_t *player, framebuffer_t *fb, fb_draw_cb_t draw, framebuffer_t *mix,
+        uint32_t duration_ms)
+{
+    CHECK_ARG(player);
+
+    xSemaphoreTake(player->mutex, portMAX_DELAY);
+    esp_err_t res = player->playing
+            ? start_crossfade(player, fb, draw, mix, duration_ms)
+            : ESP_ERR_INVALID_STATE;
+    xSemaphoreGive(player->mutex);
+
+    return res;
+}
+
+esp_err_t player_finish_crossfade(player_t *player)
+{
+    CHECK_ARG(player);
+
+    xSemaphoreTake(player->mutex, portMAX_DELAY);
+    bool playing = player->playing;
+    xSemaphoreGive(player->mutex);
+    if (!playing)
+        return ESP_ERR_INVALID_STATE;
+
+    // crossfade may still be queued, render side executes commands in order
+    command_t cmd = { .type = PLAYER_CMD_FINISH };
+    CHECK(player_send(player, &cmd));
+    player->finish_sent++;
+
+    // commands are taken every frame period, paused or not; a command that
+    // timed out before may be executed first and give the semaphore too
+    while (xSemaphoreTake(player->finish, pdMS_TO_TICKS(PLAYER_FINISH_TIMEOUT_MS)))
+    {
+        xSemaphoreTake(player->mutex, portMAX_DELAY);
+        bool done = (int32_t)(player->finished - player->finish_sent) >= 0 || !player->playing;
+        xSemaphoreGive(player->mutex);
+        if (done)
+            return ESP_OK;
+    }
+
+    return ESP_ERR_TIMEOUT;
+}
+
+esp_err_t player_set_command_handler(player_t *player, player_command_cb_t handler, void *ctx)
+{
+    CHECK_ARG(player);
+
+    xSemaphoreTake(player->mutex, portMAX_DELAY);
+    player->handler = handler;
+    player->handler_ctx = ctx;
+    xSemaphoreGive(player->mutex);
+
+    return ESP_OK;
+}
+
+esp_err_t player_send(player_t *player, const command_t *cmd)
+{
+    CHECK_ARG(player && cmd);
+
+    command_t sent = *cmd;
+    sent.sent = esp_timer_get_time();
+
+    return command_queue_push(&player->commands, &sent) ? ESP_OK : ESP_ERR_NO_MEM;
+}
@@ -0,0 +1,260 @@
+/**
+ * @file player.h
+ *
+ * @defgroup led_player led_player
+ * @{
+ *
+ * Effect player with adaptive frame rate
+ *
+ * Replaces fb_animation: renders frames of an effect from esp_timer and
+ * flushes them with fb_render(), but every frame is scheduled against its
+ * own deadline. Draw and render time of every frame is measured, frames
+ * taking longer than their period are counted as deadline misses.
+ *
+ * Frame rate follows the cost of the effect: when average frame time
+ * exceeds PLAYER_LOAD_HIGH percent of the period, FPS is lowered to keep
+ * frames at PLAYER_LOAD_TARGET percent. FPS is raised back only after
+ * a second of frames that would fit PLAYER_LOAD_TARGET percent at a higher
+ * rate, so it doesn't oscillate.
+ *
+ * Effects can be switched with a crossfade: for its duration both the
+ * outgoing and the incoming effect are drawn into their own framebuffers,
+ * blended with blend_rgb() into a third one, which is rendered. Blend time
+ * is measured separately, frame rate adapts to the cost of both effects.
+ *
+ * Player is driven by commands sent with player_send() into a lock-free
+ * single-producer queue, executed at the start of every frame on the render
+ * side, so nothing waits for a frame in progress. The render side is the
+ * only consumer, even player_finish_crossfade() sends a command and waits
+ * for it. Time from sending to the end of the first affected frame is
+ * measured.
+ *
+ * Player has its own esp_timer by default. Players initialized with
+ * player_init_scheduled() have none, their frames are rendered with
+ * player_frame() by a scheduler driving several players, see scheduler.h.
+ *
+ * With CONFIG_EXAMPLE_PROFILE CPU cycles of effect draw (compute), of
+ * blending and of render (output) are also collected into histograms,
+ * without it they are not compiled in at all.
+ */
+#ifndef __LED_PLAYER_H__
+#define __LED_PLAYER_H__
+
+#include <sdkconfig.h>
+#include <esp_timer.h>
+#include <framebuffer.h>
+#include <fbanimation.h>
+
+#include "player/command.h"
+
+#ifdef CONFIG_EXAMPLE_PROFILE
+#include "player/profile.h"
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define PLAYER_LOAD_TARGET 75 ///< Frame time after FPS change, percents of period
+#define PLAYER_LOAD_HIGH   90 ///< Frame time triggering FPS drop, percents of period
+
+#define PLAYER_FINISH_TIMEOUT_MS 1000 ///< Longest wait for render side in player_finish_crossfade()
+
+/**
+ * Commands executed by player itself, others are passed to command handler
+ */
+typedef enum {
+    PLAYER_CMD_CROSSFADE = 0, ///< Crossfade to effect drawn by `draw` into `fb`, blended in `mix`, for `value` ms
+    PLAYER_CMD_PAUSE,         ///< Stop drawing if `value` is not 0, resume otherwise
+    PLAYER_CMD_FINISH,        ///< Finish crossfade at once, sent by player_finish_crossfade()
+    PLAYER_CMD_USER,          ///< First command type of command handler
+} player_command_type_t;
+
+/**
+ * Command handler, runs on render side between frames
+ */
+typedef esp_err_t (*player_command_cb_t)(const command_t *cmd, void *ctx);
+
+/**
+ * Statistics of the current effect
+ */
+typedef struct
+{
+    uint32_t frames;         ///< Rendered frames
+    uint32_t missed;         ///< Frames exceeded their period
+    uint32_t draw_us;        ///< Average effect draw time, us
+    uint32_t render_us;      ///< Average render and flush time, us
+    uint32_t blend_us;       ///< Average blend time of crossfade frames, us
+    uint32_t blended;        ///< Crossfade frames
+    uint32_t max_us;         ///< Longest frame, us
+    uint32_t max_gap_us;     ///< Longest time between ends of two frames, us
+    uint32_t commands;       ///< Executed commands
+    uint32_t latency_us;     ///< Average time from sending to the end of the first affected frame, us
+    uint32_t max_latency_us; ///< Longest command latency, us
+} player_stats_t;
+
+/**
+ * Player descriptor
+ */
+typedef struct
+{
+    framebuffer_t *fb;
+    esp_timer_handle_t timer;    ///< Frame timer, NULL if frames are rendered by scheduler
+    SemaphoreHandle_t mutex;
+    fb_draw_cb_t draw;           ///< Effect draw function
+    void *render_ctx;            ///< Render context passed to fb_render()
+    bool playing;
+    bool paused;                 ///< Nothing is drawn, commands are still executed
+    uint8_t min_fps;             ///< Lowest allowed FPS
+    uint8_t max_fps;             ///< Highest allowed FPS, played first
+    uint8_t fps;                 ///< Current FPS
+    int64_t deadline;            ///< End of the current frame period, us
+    int64_t last_end;            ///< End of the previous frame, us, 0 before the first one
+    framebuffer_t *next_fb;      ///< Framebuffer of the incoming effect, NULL if not fading
+    fb_draw_cb_t next_draw;      ///< Incoming effect draw function
+    framebuffer_t *mix;          ///< Framebuffer crossfade frames are blended into
+    int64_t fade_start;          ///< Start of crossfade, us
+    uint32_t fade_us;            ///< Crossfade duration, us
+    uint32_t stable;             ///< Frames in a row that would fit higher FPS
+    command_queue_t commands;    ///< Commands to execute on the next frame
+    uint32_t finished;           ///< PLAYER_CMD_FINISH commands executed
+    uint32_t finish_sent;        ///< PLAYER_CMD_FINISH commands sent
+    SemaphoreHandle_t finish;    ///< Given by render side after PLAYER_CMD_FINISH
+    player_command_cb_t handler; ///< Handler of commands from PLAYER_CMD_USER up
+    void *handler_ctx;           ///< Context passed to handler
+    player_stats_t stats;        ///< Statistics of the current effect
+#ifdef CONFIG_EXAMPLE_PROFILE
+    profile_hist_t compute;      ///< Effect draw cycles
+    profile_hist_t blend;        ///< Crossfade blend cycles
+    profile_hist_t output;       ///< Render cycles
+#endif
+} player_t;
+
+/**
+ * @brief Init player
+ *
+ * @param player Player descriptor
+ * @param fb Framebuffer
+ * @param min_fps Lowest allowed FPS
+ * @param max_fps Highest allowed FPS
+ * @return `ESP_OK` on success
+ */
+esp_err_t player_init(player_t *player, framebuffer_t *fb, uint8_t min_fps, uint8_t max_fps);
+
+/**
+ * @brief Init player without its own timer
+ *
+ * Frames are rendered only by player_frame().
+ *
+ * @param player Player descriptor
+ * @param fb Framebuffer
+ * @param min_fps Lowest allowed FPS
+ * @param max_fps Highest allowed FPS
+ * @return `ESP_OK` on success
+ */
+esp_err_t player_init_scheduled(player_t *player, framebuffer_t *fb, uint8_t min_fps, uint8_t max_fps);
+
+/**
+ * @brief Execute queued commands and render a frame
+ *
+ * For players initialized with player_init_scheduled(), called at the
+ * deadline of the frame.
+ *
+ * @param player Player descriptor
+ * @param[out] deadline Time of the next frame, esp_timer time in us
+ * @return `ESP_OK` on success, `ESP_ERR_INVALID_STATE` if nothing is playing
+ */
+esp_err_t player_frame(player_t *player, int64_t *deadline);
+
+/**
+ * @brief Free player resources
+ *
+ * @param player Player descriptor
+ * @return `ESP_OK` on success
+ */
+esp_err_t player_free(player_t *player);
+
+/**
+ * @brief Start playing effect at max FPS, reset statistics
+ *
+ * @param player Player descriptor
+ * @param draw Effect draw function
+ * @param render_ctx Render context passed to fb_render()
+ * @return `ESP_OK` on success
+ */
+esp_err_t player_play(player_t *player, fb_draw_cb_t draw, void *render_ctx);
+
+/**
+ * @brief Crossfade from the playing effect to a new one
+ *
+ * Both effects are drawn every frame for `duration_ms`, then only the new
+ * one is played from `fb`. The outgoing effect is not drawn anymore after
+ * that, but its framebuffer is not touched. Statistics are reset, FPS is
+ * kept. Crossfade still running is finished at once. With `duration_ms` 0
+ * effects are switched on the next frame without blending.
+ *
+ * @param player Player descriptor
+ * @param fb Framebuffer of the new effect, same size as the playing one
+ * @param draw New effect draw function
+ * @param mix Framebuffer to blend frames into, same size, its render
+ *            callback must be the one of the playing framebuffer
+ * @param duration_ms Crossfade duration, ms
+ * @return `ESP_OK` on success, `ESP_ERR_INVALID_STATE` if nothing is playing
+ */
+esp_err_t player_crossfade(player_t *player, framebuffer_t *fb, fb_draw_cb_t draw, framebuffer_t *mix,
+        uint32_t duration_ms);
+
+/**
+ * @brief Finish crossfade at once
+ *
+ * Sends PLAYER_CMD_FINISH and blocks until the render side has executed
+ * it, at most PLAYER_FINISH_TIMEOUT_MS. Commands queued before are
+ * executed first, so a crossfade still queued is started and finished
+ * too. Only the incoming effect is played then, so framebuffer of the
+ * outgoing one may be reused. Finishes nothing if there is no crossfade.
+ * Must be called from the task sending commands.
+ *
+ * @param player Player descriptor
+ * @return `ESP_OK` on success, `ESP_ERR_INVALID_STATE` if nothing is
+ *         playing, `ESP_ERR_NO_MEM` if command queue is full,
+ *         `ESP_ERR_TIMEOUT` if the command was not executed in time
+ */
+esp_err_t player_finish_crossfade(player_t *player);
+
+/**
+ * @brief Set handler of commands player doesn't know
+ *
+ * @param player Player descriptor
+ * @param handler Command handler, NULL to ignore such commands
+ * @param ctx Context passed to handler
+ * @return `ESP_OK` on success
+ */
+esp_err_t player_set_command_handler(player_t *player, player_command_cb_t handler, void *ctx);
+
+/**
+ * @brief Send command, it is executed before the next frame
+ *
+ * Lock-free, never waits for render side. Commands must be sent from
+ * a single task. Time of sending is set here.
+ *
+ * @param player Player descriptor
+ * @param cmd Command, copied
+ * @return `ESP_OK` on success, `ESP_ERR_NO_MEM` if command queue is full
+ */
+esp_err_t player_send(player_t *player, const command_t *cmd);
+
+/**
+ * @brief Stop playing, waits for the current frame
+ *
+ * @param player Player descriptor
+ * @return `ESP_OK` on success
+ */
+esp_err_t player_stop(player_t *player);
+
+#ifdef __cplusplus
+}
+#endif
+
+/**@}*/
+
+#endif /* __LED_PLAYER_H__ */
@@ -0,0 +1,66 @@
+/**
+ * @file profile.c
+ *
+ * Fixed-bucket histograms of CPU cycles
+ */
+#include <string.h>
+
+#include "player/profile.h"
+
+// values below 4 get their own buckets, above that 4 buckets per power of two
+static uint32_t bucket(uint32_t value)
+{
+    if (value < 4)
+        return value;
+
+    uint32_t msb = 31 - __builtin_clz(value);
+
+    return (msb - 1) * 4 + ((value >> (msb - 2)) & 3);
+}
+
+static uint32_t bucket_upper(uint32_t b)
+{
+    if (b < 3)
+        return b;
+    if (b == PROFILE_BUCKETS - 1)
+        return UINT32_MAX;
+
+    // lower bound of the next bucket minus one
+    b++;
+    return ((4 + b % 4) << (b / 4 - 1)) - 1;
+}
+
+void profile_hist_reset(profile_hist_t *hist)
+{
+    memset(hist, 0, sizeof(profile_hist_t));
+}
+
+void profile_hist_add(profile_hist_t *hist, uint32_t value)
+{
+    if (!hist->count || value < hist->min)
+        hist->min = value;
+    if (value > hist->max)
+        hist->max = value;
+    hist->count++;
+    hist->buckets[bucket(value)]++;
+}
+
+uint32_t profile_hist_percentile(const profile_hist_t *hist, uint32_t pct)
+{
+    if (!hist->count)
+        return 0;
+
+    uint64_t rank = (uint64_t)hist->count * pct;
+    uint64_t seen = 0;
+    for (uint32_t b = 0; b < PROFILE_BUCKETS; b++)
+    {
+        seen += hist->buckets[b];
+        if (seen * 100 >= rank && hist->buckets[b])
+        {
+            uint32_t upper = bucket_upper(b);
+            return upper > hist->max ? hist->max : upper < hist->min ? hist->min : upper;
+        }
+    }
+
+    return hist->max;
+}
@@ -0,0 +1,65 @@
+/**
+ * @file profile.h
+ *
+ * @defgroup led_profile led_profile
+ * @{
+ *
+ * Fixed-bucket histograms of CPU cycles
+ *
+ * Every power of two is split into 4 buckets, so percentiles are accurate
+ * within 1/4 of an octave, min and max are exact. Adding a sample is a few
+ * instructions, no dependencies on ESP-IDF.
+ */
+#ifndef __LED_PROFILE_H__
+#define __LED_PROFILE_H__
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define PROFILE_BUCKETS 124
+
+/**
+ * Histogram
+ */
+typedef struct
+{
+    uint32_t count;                     ///< Number of samples
+    uint32_t min;                       ///< Smallest sample
+    uint32_t max;                       ///< Largest sample
+    uint32_t buckets[PROFILE_BUCKETS];  ///< Samples per bucket
+} profile_hist_t;
+
+/**
+ * @brief Clear histogram
+ *
+ * @param hist Histogram
+ */
+void profile_hist_reset(profile_hist_t *hist);
+
+/**
+ * @brief Add sample
+ *
+ * @param hist Histogram
+ * @param value Sample, usually CPU cycles
+ */
+void profile_hist_add(profile_hist_t *hist, uint32_t value);
+
+/**
+ * @brief Get percentile
+ *
+ * @param hist Histogram
+ * @param pct Percentile, 0..100
+ * @return Upper bound of bucket containing percentile, 0 if empty
+ */
+uint32_t profile_hist_percentile(const profile_hist_t *hist, uint32_t pct);
+
+#ifdef __cplusplus
+}
+#endif
+
+/**@}*/
+
+#endif /* __LED_PROFILE_H__ */
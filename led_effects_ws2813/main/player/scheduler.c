@@ -0,0 +1,163 @@
+/**
+ * @file scheduler.c
+ *
+ * Earliest deadline first scheduler of several players
+ */
+#include <stdint.h>
+
+#include "player/scheduler.h"
+
+#define CHECK(x) do { esp_err_t __; if ((__ = x) != ESP_OK) return __; } while (0)
+#define CHECK_ARG(VAL) do { if (!(VAL)) return ESP_ERR_INVALID_ARG; } while (0)
+
+#define IDLE INT64_MAX
+
+// due player with the earliest deadline, `last` only if no other is due;
+// SCHEDULER_MAX_PLAYERS if none is due
+static size_t next_due(const scheduler_t *scheduler, int64_t now, size_t last)
+{
+    size_t first = SCHEDULER_MAX_PLAYERS;
+    for (size_t i = 0; i < scheduler->num_players; i++)
+    {
+        if (scheduler->deadlines[i] > now)
+            continue;
+        if (first == SCHEDULER_MAX_PLAYERS || first == last
+                || (i != last && scheduler->deadlines[i] < scheduler->deadlines[first]))
+            first = i;
+    }
+
+    return first;
+}
+
+// called with mutex taken, timer not running
+static void schedule(scheduler_t *scheduler, int64_t now)
+{
+    int64_t deadline = IDLE;
+    for (size_t i = 0; i < scheduler->num_players; i++)
+        if (scheduler->deadlines[i] < deadline)
+            deadline = scheduler->deadlines[i];
+
+    if (deadline != IDLE)
+        esp_timer_start_once(scheduler->timer, deadline > now ? deadline - now : 0);
+}
+
+static void run(void *arg)
+{
+    scheduler_t *scheduler = (scheduler_t *)arg;
+
+    xSemaphoreTake(scheduler->mutex, portMAX_DELAY);
+    scheduler->stats.runs++;
+
+    // at most one frame per player in a run, esp_timer task gets a breath in between
+    int64_t now = esp_timer_get_time();
+    size_t last = SCHEDULER_MAX_PLAYERS;
+    for (size_t n = 0; n < scheduler->num_players; n++)
+    {
+        size_t i = next_due(scheduler, now, last);
+        if (i == SCHEDULER_MAX_PLAYERS)
+            break;
+
+        if (now - scheduler->deadlines[i] > scheduler->stats.max_late)
+            scheduler->stats.max_late = now - scheduler->deadlines[i];
+        if (player_frame(scheduler->players[i], &scheduler->deadlines[i]) == ESP_OK)
+            scheduler->stats.frames++;
+        else
+            scheduler->deadlines[i] = IDLE;
+
+        last = i;
+        now = esp_timer_get_time();
+    }
+
+    schedule(scheduler, now);
+    xSemaphoreGive(scheduler->mutex);
+}
+
+esp_err_t scheduler_init(scheduler_t *scheduler)
+{
+    CHECK_ARG(scheduler);
+
+    scheduler->num_players = 0;
+    scheduler->stats = (scheduler_stats_t) { 0 };
+
+    scheduler->mutex = xSemaphoreCreateMutex();
+    if (!scheduler->mutex)
+        return ESP_ERR_NO_MEM;
+
+    esp_timer_create_args_t args = {
+        .callback = run,
+        .arg = scheduler,
+        .dispatch_method = ESP_TIMER_TASK,
+        .name = "scheduler",
+    };
+    esp_err_t res = esp_timer_create(&args, &scheduler->timer);
+    if (res != ESP_OK)
+        vSemaphoreDelete(scheduler->mutex);
+
+    return res;
+}
+
+esp_err_t scheduler_free(scheduler_t *scheduler)
+{
+    CHECK_ARG(scheduler);
+
+    // run in progress finishes first
+    xSemaphoreTake(scheduler->mutex, portMAX_DELAY);
+    esp_timer_stop(scheduler->timer);
+    xSemaphoreGive(scheduler->mutex);
+
+    CHECK(esp_timer_delete(scheduler->timer));
+    vSemaphoreDelete(scheduler->mutex);
+
+    return ESP_OK;
+}
+
+esp_err_t scheduler_add(scheduler_t *scheduler, player_t *player)
+{
+    CHECK_ARG(scheduler && player && !player->timer);
+
+    xSemaphoreTake(scheduler->mutex, portMAX_DELAY);
+    esp_err_t res = ESP_ERR_NO_MEM;
+    if (scheduler->num_players < SCHEDULER_MAX_PLAYERS)
+    {
+        scheduler->players[scheduler->num_players] = player;
+        scheduler->deadlines[scheduler->num_players] = IDLE;
+        scheduler->num_players++;
+        res = ESP_OK;
+    }
+    xSemaphoreGive(scheduler->mutex);
+
+    return res;
+}
+
+esp_err_t scheduler_play(scheduler_t *scheduler, player_t *player, fb_draw_cb_t draw, void *render_ctx)
+{
+    CHECK_ARG(scheduler && player);
+
+    size_t i = 0;
+    while (i < scheduler->num_players && scheduler->players[i] != player)
+        i++;
+    CHECK_ARG(i < scheduler->num_players);
+
+    CHECK(player_play(player, draw, render_ctx));
+
+    // first frame is due now, reschedule
+    xSemaphoreTake(scheduler->mutex, portMAX_DELAY);
+    int64_t now = esp_timer_get_time();
+    esp_timer_stop(scheduler->timer);
+    scheduler->deadlines[i] = now;
+    schedule(scheduler, now);
+    xSemaphoreGive(scheduler->mutex);
+
+    return ESP_OK;
+}
+
+esp_err_t scheduler_reset_stats(scheduler_t *scheduler)
+{
+    CHECK_ARG(scheduler);
+
+    xSemaphoreTake(scheduler->mutex, portMAX_DELAY);
+    scheduler->stats = (scheduler_stats_t) { 0 };
+    xSemaphoreGive(scheduler->mutex);
+
+    return ESP_OK;
+}
@@ -0,0 +1,105 @@
+/**
+ * @file scheduler.h
+ *
+ * @defgroup led_scheduler led_scheduler
+ * @{
+ *
+ * Earliest deadline first scheduler of several players
+ *
+ * Every player is an independent zone with its own framebuffer, effect,
+ * frame rate and render context (output stage). Frames of all players are
+ * rendered from a single esp_timer callback, so zones don't need a task
+ * and a stack each: the callback renders the player with the earliest
+ * deadline as long as it is due, then sleeps until the next deadline.
+ * A late player is not rendered twice in a row while others are due,
+ * so a slow zone delays the others by at most one of its frames.
+ */
+#ifndef __LED_SCHEDULER_H__
+#define __LED_SCHEDULER_H__
+
+#include "player/player.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define SCHEDULER_MAX_PLAYERS 4 ///< Max number of players of a scheduler
+
+/**
+ * Scheduler statistics
+ */
+typedef struct
+{
+    uint32_t runs;     ///< Timer callbacks
+    uint32_t frames;   ///< Frames rendered, all players
+    uint32_t max_late; ///< Longest time from deadline to the start of a frame, us
+} scheduler_stats_t;
+
+/**
+ * Scheduler descriptor
+ */
+typedef struct
+{
+    esp_timer_handle_t timer;
+    SemaphoreHandle_t mutex;
+    size_t num_players;                              ///< Number of players
+    player_t *players[SCHEDULER_MAX_PLAYERS];        ///< Players, initialized with player_init_scheduled()
+    int64_t deadlines[SCHEDULER_MAX_PLAYERS];        ///< Next frame of every player, INT64_MAX if stopped
+    scheduler_stats_t stats;                         ///< Statistics since the last scheduler_reset_stats()
+} scheduler_t;
+
+/**
+ * @brief Init scheduler
+ *
+ * @param scheduler Scheduler descriptor
+ * @return `ESP_OK` on success
+ */
+esp_err_t scheduler_init(scheduler_t *scheduler);
+
+/**
+ * @brief Stop scheduler and free its resources, players are not freed
+ *
+ * @param scheduler Scheduler descriptor
+ * @return `ESP_OK` on success
+ */
+esp_err_t scheduler_free(scheduler_t *scheduler);
+
+/**
+ * @brief Add player
+ *
+ * @param scheduler Scheduler descriptor
+ * @param player Player initialized with player_init_scheduled(), not playing
+ * @return `ESP_OK` on success, `ESP_ERR_NO_MEM` if there are
+ *         SCHEDULER_MAX_PLAYERS players already
+ */
+esp_err_t scheduler_add(scheduler_t *scheduler, player_t *player);
+
+/**
+ * @brief Start playing effect on a player of scheduler
+ *
+ * Same as player_play(), the first frame is rendered as soon as possible.
+ * Players are stopped with player_stop().
+ *
+ * @param scheduler Scheduler descriptor
+ * @param player Player added to scheduler
+ * @param draw Effect draw function
+ * @param render_ctx Render context passed to fb_render()
+ * @return `ESP_OK` on success
+ */
+esp_err_t scheduler_play(scheduler_t *scheduler, player_t *player, fb_draw_cb_t draw, void *render_ctx);
+
+/**
+ * @brief Reset statistics
+ *
+ * @param scheduler Scheduler descriptor
+ * @return `ESP_OK` on success
+ */
+esp_err_t scheduler_reset_stats(scheduler_t *scheduler);
+
+#ifdef __cplusplus
+}
+#endif
+
+/**@}*/
+
+#endif /* __LED_SCHEDULER_H__ */
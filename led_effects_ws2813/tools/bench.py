@@ -0,0 +1,61 @@
+#!/usr/bin/env python
+#
+# Extract and compare effect benchmark results printed with
+# CONFIG_EXAMPLE_EFFECT_BENCHMARK.
+#
+# Usage:
+#   bench.py csv LOG                    print results of monitor log as CSV
+#   bench.py diff OLD_LOG NEW_LOG [PCT] compare ns per frame, fail if any
+#                                       effect got slower by more than PCT
+#                                       percents (default 10)
+
+from __future__ import print_function
+
+import csv
+import sys
+
+PREFIX = 'BENCH,'
+
+
+def read_results(path):
+    rows = []
+    with open(path) as f:
+        for line in f:
+            idx = line.find(PREFIX)
+            if idx >= 0:
+                rows.append(line[idx + len(PREFIX):].strip())
+    return list(csv.DictReader(rows))
+
+
+def key(row):
+    return (row['effect'], int(row['width']), int(row['height']))
+
+
+def diff(old_path, new_path, threshold):
+    old = {key(r): r for r in read_results(old_path)}
+    regressions = 0
+    print('effect,width,height,old_ns_per_frame,new_ns_per_frame,change_pct')
+    for row in read_results(new_path):
+        if key(row) not in old:
+            continue
+        before = int(old[key(row)]['ns_per_frame'])
+        after = int(row['ns_per_frame'])
+        change = (after - before) * 100.0 / before if before else 0.0
+        if change > threshold:
+            regressions += 1
+        print('%s,%d,%d,%d,%d,%.1f' % (key(row) + (before, after, change)))
+    return 1 if regressions else 0
+
+
+if __name__ == '__main__':
+    if len(sys.argv) == 3 and sys.argv[1] == 'csv':
+        results = read_results(sys.argv[2])
+        if results:
+            writer = csv.DictWriter(sys.stdout, fieldnames=list(results[0].keys()))
+            writer.writeheader()
+            writer.writerows(results)
+    elif len(sys.argv) in (4, 5) and sys.argv[1] == 'diff':
+        sys.exit(diff(sys.argv[2], sys.argv[3], float(sys.argv[4]) if len(sys.argv) == 5 else 10.0))
+    else:
+        print('usage: bench.py csv LOG | diff OLD_LOG NEW_LOG [PCT]')
+        sys.exit(2)
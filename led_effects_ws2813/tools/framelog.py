@@ -0,0 +1,95 @@
+#!/usr/bin/env python
+#
+# Dump and compare frame logs recorded by mock output backend,
+# see main/output/frame_log.h for the format.
+#
+# Usage:
+#   framelog.py dump LOG
+#   framelog.py diff LOG_A LOG_B
+#   framelog.py check LOG RECORDS  fail unless the log has RECORDS records,
+#                                  numbered in order, matching their data
+
+from __future__ import print_function
+
+import struct
+import sys
+
+HEADER = struct.Struct('<4sHH')
+RECORD = struct.Struct('<QHHIII')
+FLAG_DATA = 0x0001
+
+
+def read_log(path):
+    with open(path, 'rb') as f:
+        magic, version, flags = HEADER.unpack(f.read(HEADER.size))
+        if magic != b'LEDF' or version != 1:
+            raise ValueError('%s: not a frame log' % path)
+        while True:
+            buf = f.read(RECORD.size)
+            if len(buf) < RECORD.size:
+                break
+            time_us, lane, _, frame, size, checksum = RECORD.unpack(buf)
+            data = f.read(size) if flags & FLAG_DATA else None
+            yield time_us, lane, frame, size, checksum, data
+
+
+def fnv1a(data):
+    h = 0x811c9dc5
+    for b in bytearray(data):
+        h = ((h ^ b) * 0x01000193) & 0xffffffff
+    return h
+
+
+def dump(path):
+    for time_us, lane, frame, size, checksum, _ in read_log(path):
+        print('%12d us  lane %d  frame %6d  %5d bytes  %08x' % (time_us, lane, frame, size, checksum))
+
+
+def diff(path_a, path_b):
+    # timestamps differ between runs, frames are compared by lane and number
+    frames = {}
+    for _, lane, frame, _, checksum, _ in read_log(path_a):
+        frames[(lane, frame)] = checksum
+    differ = 0
+    compared = 0
+    for _, lane, frame, _, checksum, _ in read_log(path_b):
+        if (lane, frame) not in frames:
+            continue
+        compared += 1
+        if frames[(lane, frame)] != checksum:
+            differ += 1
+            print('lane %d frame %d: %08x != %08x' % (lane, frame, frames[(lane, frame)], checksum))
+    print('%d frames compared, %d differ' % (compared, differ))
+    return 1 if differ else 0
+
+
+def check(path, expected):
+    records = 0
+    failed = 0
+    last = {}
+    for _, lane, frame, size, checksum, data in read_log(path):
+        records += 1
+        if frame != last.get(lane, 0) + 1:
+            print('lane %d frame %d: expected frame %d' % (lane, frame, last.get(lane, 0) + 1))
+            failed += 1
+        last[lane] = frame
+        if data is not None and (len(data) != size or fnv1a(data) != checksum):
+            print('lane %d frame %d: data does not match checksum %08x' % (lane, frame, checksum))
+            failed += 1
+    if records != expected:
+        print('%d records, expected %d' % (records, expected))
+        failed += 1
+    print('%d records checked, %d failed' % (records, failed))
+    return 1 if failed else 0
+
+
+if __name__ == '__main__':
+    if len(sys.argv) == 3 and sys.argv[1] == 'dump':
+        dump(sys.argv[2])
+    elif len(sys.argv) == 4 and sys.argv[1] == 'diff':
+        sys.exit(diff(sys.argv[2], sys.argv[3]))
+    elif len(sys.argv) == 4 and sys.argv[1] == 'check':
+        sys.exit(check(sys.argv[2], int(sys.argv[3])))
+    else:
+        print('usage: framelog.py dump LOG | diff LOG_A LOG_B | check LOG RECORDS')
+        sys.exit(2)
@@ -0,0 +1,61 @@
+#!/usr/bin/env python
+#
+# Record and check golden checksums of effects printed with
+# CONFIG_EXAMPLE_EFFECT_GOLDEN.
+#
+# Usage:
+#   golden.py record LOG > golden.csv  save checksums of a reference build
+#   golden.py check LOG golden.csv     compare checksums of a new build,
+#                                      fail if any effect renders differently
+
+from __future__ import print_function
+
+import csv
+import sys
+
+PREFIX = 'GOLDEN,'
+
+
+def read_checksums(lines):
+    rows = []
+    for line in lines:
+        idx = line.find(PREFIX)
+        if idx >= 0:
+            rows.append(line[idx + len(PREFIX):].strip())
+    return {(r['effect'], r['width'], r['height'], r['frames']): r['checksum'] for r in csv.DictReader(rows)}
+
+
+def record(log):
+    with open(log) as f:
+        checksums = read_checksums(f)
+    # same format as the log, so both are read the same way
+    print(PREFIX + 'effect,width,height,frames,checksum')
+    for key in sorted(checksums):
+        print(PREFIX + ','.join(key + (checksums[key],)))
+
+
+def check(log, golden):
+    with open(log) as f:
+        actual = read_checksums(f)
+    with open(golden) as f:
+        expected = read_checksums(f)
+    failed = 0
+    for key in sorted(expected):
+        if key not in actual:
+            print('%s: missing' % key[0])
+            failed += 1
+        elif actual[key] != expected[key]:
+            print('%s: %s != %s' % (key[0], actual[key], expected[key]))
+            failed += 1
+    print('%d effects checked, %d failed' % (len(expected), failed))
+    return 1 if failed else 0
+
+
+if __name__ == '__main__':
+    if len(sys.argv) == 3 and sys.argv[1] == 'record':
+        record(sys.argv[2])
+    elif len(sys.argv) == 4 and sys.argv[1] == 'check':
+        sys.exit(check(sys.argv[2], sys.argv[3]))
+    else:
+        print('usage: golden.py record LOG | check LOG GOLDEN')
+        sys.exit(2)